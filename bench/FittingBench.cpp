@@ -0,0 +1,535 @@
+// Throughput baseline of the hw1 fitting kernels (GAMES102_Fitting), without
+// ImGui or Utopia. For every fit type and point count it reports
+//   fit ms        fitting from scratch, Sync + Weights on a fresh engine
+//   push us       appending one point to a fitted engine and solving again
+//   eval ns       evaluating the fit, per sample of a canvas-like grid
+// Dense methods are capped where they stop being interactive. A second table
+// compares fitting a curve's x and y separately with one shared factorization,
+// a third streams millions of samples through StreamingLSFit. The PF accuracy
+// table compares the float evaluation of monomial and Chebyshev weights with a
+// double evaluation of the same weights, the last one parameterizes long
+// polylines against the former serial loop. For the param rows push us is
+// ParameterizationCache after appending a point. The auto tune table scores
+// 200 FR lambdas with one GCV sweep against refitting and scoring each, and
+// 100 GI sigmas by closed form leave-one-out, O(n^3) per sigma so only for
+// small counts.
+#include "Barycentric.h"
+#include "BSplineFit.h"
+#include "CrossValidation.h"
+#include "CompactRBF.h"
+#include "FastGauss.h"
+#include "FittingEngine.h"
+#include "FittingKernels.h"
+#include "MovingLS.h"
+#include "PolynomialEval.h"
+#include "StreamingFit.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	// Average seconds of f, repeated for at least 100ms unless one call is longer.
+	double Seconds(const std::function<void()>& f) {
+		int repeat = 0;
+		Clock::duration elapsed{};
+		Clock::time_point begin = Clock::now();
+		do {
+			f();
+			++repeat;
+			elapsed = Clock::now() - begin;
+		} while (elapsed < std::chrono::milliseconds(100));
+		return std::chrono::duration<double>(elapsed).count() / repeat;
+	}
+
+	volatile float sink;
+
+	const float SIGMA = 10;
+	const float FGT_TOLERANCE = 1e-4f;
+	const int EVAL_COUNT = 10000;
+
+	struct Samples {
+		std::vector<float> xs;
+		std::vector<float> ys;
+		// One more point, appended by the push measurement.
+		float nextX;
+		float nextY;
+		// Evaluation grid over [xs.front(), xs.back()].
+		std::vector<float> grid;
+	};
+
+	// About one point per unit like canvas pixels, a smooth signal plus noise.
+	Samples MakeSamples(int count, std::mt19937& rng) {
+		std::uniform_real_distribution<float> jitter(0.f, 0.5f);
+		std::normal_distribution<float> noise(0.f, 5.f);
+		Samples s;
+		s.xs.resize(count);
+		s.ys.resize(count);
+		for (int i = 0; i <= count; ++i) {
+			float x = i + jitter(rng);
+			float y = 300.f + 100.f * std::sin(x * 0.02f) + noise(rng);
+			if (i < count) {
+				s.xs[i] = x;
+				s.ys[i] = y;
+			}
+			else {
+				s.nextX = x;
+				s.nextY = y;
+			}
+		}
+		s.grid.resize(EVAL_COUNT);
+		float delta = (s.xs.back() - s.xs.front()) / EVAL_COUNT;
+		SampleRange(s.xs.front(), s.xs.back(), delta, s.grid.data(), EVAL_COUNT);
+		return s;
+	}
+
+	void PrintRow(const std::string& name, int count, double fit, double push, double eval) {
+		std::printf("%-24s %9d %12.4f %12.3f %12.2f\n", name.c_str(), count, fit * 1e3, push * 1e6, eval * 1e9 / EVAL_COUNT);
+	}
+
+	// Engine: IncrementalFit with a setup(engine) step, evaluated by eval(engine, ys).
+	template<typename Engine, typename Setup, typename Eval>
+	void Run(const std::string& name, const Samples& s, Setup&& setup, Eval&& eval) {
+		int n = static_cast<int>(s.xs.size());
+		double fit = Seconds([&]() {
+			Engine engine;
+			setup(engine);
+			engine.Sync(s.xs, s.ys);
+			sink = engine.Weights()(0);
+		});
+
+		Engine engine;
+		setup(engine);
+		engine.Sync(s.xs, s.ys);
+		engine.Weights();
+		std::vector<float> xs = s.xs;
+		std::vector<float> ys = s.ys;
+		xs.push_back(s.nextX);
+		ys.push_back(s.nextY);
+		// Alternate between n + 1 and n points, each step is one push or one pop.
+		int step = 0;
+		double push = Seconds([&]() {
+			if (step++ % 2 == 0) {
+				engine.Sync(xs, ys);
+			}
+			else {
+				engine.Sync(s.xs, s.ys);
+			}
+			sink = engine.Weights()(0);
+		});
+		engine.Sync(s.xs, s.ys);
+		engine.Weights();
+
+		std::vector<float> out(EVAL_COUNT);
+		double evalTime = Seconds([&]() {
+			eval(engine, out.data());
+			sink = out[EVAL_COUNT / 2];
+		});
+		PrintRow(name, n, fit, push, evalTime);
+	}
+
+	template<typename Engine>
+	void RunPolynomial(const std::string& name, const Samples& s, const std::function<void(Engine&)>& setup) {
+		Run<Engine>(name, s, setup, [&](Engine& engine, float* out) {
+			const Eigen::MatrixXf& w = engine.Weights();
+			EvalPolynomial(w.data(), static_cast<int>(w.rows()), s.grid.data(), out, EVAL_COUNT);
+		});
+	}
+
+	void RunChebyshev(const std::string& name, const Samples& s, const std::function<void(LSEngine&)>& setup) {
+		Run<LSEngine>(name, s, [&](LSEngine& engine) {
+			engine.SetBasis(Chebyshev);
+			setup(engine);
+		}, [&](LSEngine& engine, float* out) {
+			const Eigen::MatrixXf& w = engine.Weights();
+			EvalChebyshev(w.data(), static_cast<int>(w.rows()), engine.Center(), engine.Scale(), s.grid.data(), out, EVAL_COUNT);
+		});
+	}
+
+	// RMS difference between the float evaluation of a fit and a double
+	// evaluation of the same weights at the samples, monomial against Chebyshev.
+	void RunBasisAccuracy(const Samples& s, int k) {
+		int n = static_cast<int>(s.xs.size());
+		std::vector<float> out(n);
+		auto rms = [&](const std::function<double(double)>& reference) {
+			double sum = 0;
+			for (int i = 0; i < n; ++i) {
+				double e = out[i] - reference(s.xs[i]);
+				sum += e * e;
+			}
+			return std::sqrt(sum / n);
+		};
+
+		LSEngine monomial;
+		monomial.SetFitBaseCount(k);
+		monomial.Sync(s.xs, s.ys);
+		const float* mw = monomial.Weights().data();
+		EvalPolynomial(mw, k, s.xs.data(), out.data(), n);
+		double monomialRms = rms([&](double x) {
+			double y = 0;
+			for (int j = k - 1; j >= 0; --j) {
+				y = y * x + mw[j];
+			}
+			return y;
+		});
+
+		LSEngine chebyshev;
+		chebyshev.SetFitBaseCount(k);
+		chebyshev.SetBasis(Chebyshev);
+		chebyshev.Sync(s.xs, s.ys);
+		const float* cw = chebyshev.Weights().data();
+		double center = chebyshev.Center();
+		double scale = chebyshev.Scale();
+		EvalChebyshev(cw, k, chebyshev.Center(), chebyshev.Scale(), s.xs.data(), out.data(), n);
+		double chebyshevRms = rms([&](double x) {
+			// Clenshaw in double
+			double u = (x - center) / scale;
+			double b1 = 0;
+			double b2 = 0;
+			for (int j = k - 1; j >= 1; --j) {
+				double b = 2. * u * b1 - b2 + cw[j];
+				b2 = b1;
+				b1 = b;
+			}
+			return u * b1 - b2 + cw[0];
+		});
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "PF k=%d", k);
+		std::printf("%-24s %9d %12.4g %12.4g\n", name, n, monomialRms, chebyshevRms);
+	}
+
+	// Curve fitting over t: x and y fitted by two engines, against one engine
+	// solving both columns with a shared factorization.
+	template<typename Engine>
+	void RunCurve(const std::string& name, const Samples& s, const std::function<void(Engine&)>& setup) {
+		int n = static_cast<int>(s.xs.size());
+		std::vector<float> ts(n);
+		Parameterize(s.xs.data(), s.ys.data(), n, Chordal, 30.f, ts.data());
+		const float* columns[] = { s.xs.data(), s.ys.data() };
+
+		double separate = Seconds([&]() {
+			Engine x;
+			Engine y;
+			setup(x);
+			setup(y);
+			x.Sync(ts.data(), columns[0], n);
+			y.Sync(ts.data(), columns[1], n);
+			sink = x.Weights()(0) + y.Weights()(0);
+		});
+		double shared = Seconds([&]() {
+			Engine xy;
+			setup(xy);
+			xy.Sync(ts.data(), columns, 2, n);
+			sink = xy.Weights()(0);
+		});
+		std::printf("%-24s %9d %12.4f %12.4f %11.2fx\n", name.c_str(), n, separate * 1e3, shared * 1e3, separate / shared);
+	}
+
+	// PF/FR fed chunk by chunk without keeping the samples, against LSEngine.
+	// GCV of FR k = 10 in the Chebyshev basis, and the sigma sweep for small counts.
+	void RunTune(const Samples& s) {
+		int n = static_cast<int>(s.xs.size());
+		std::vector<float> lambdas = LogSpace(1e-4f, 1e2f, 200);
+		LSEngine engine;
+		engine.SetFitBaseCount(10);
+		engine.SetBasis(Chebyshev);
+		engine.Sync(s.xs, s.ys);
+		GCVCurve curve;
+		double sweep = Seconds([&]() {
+			curve = engine.SweepLambda(lambdas);
+		});
+		// Residual of every candidate's fit at the samples, what a sweep without the decomposition costs.
+		std::vector<float> fitted(n);
+		double refit = Seconds([&]() {
+			double total = 0.;
+			for (int c = 0; c < static_cast<int>(lambdas.size()); ++c) {
+				engine.SetLambda(lambdas[c]);
+				const Eigen::MatrixXf& w = engine.Weights();
+				EvalChebyshev(w.data(), w.rows(), engine.Center(), engine.Scale(), s.xs.data(), fitted.data(), n);
+				double rss = 0.;
+				for (int i = 0; i < n; ++i) {
+					rss += (fitted[i] - s.ys[i]) * (fitted[i] - s.ys[i]);
+				}
+				total += rss;
+			}
+			sink = static_cast<float>(total);
+		});
+		char best[32];
+		std::snprintf(best, sizeof(best), "%.4g", curve.Best(NAN));
+		std::printf("%-24s %9d %12.4f %12.4f %12s\n", "GCV lambda", n, sweep * 1e3, refit * 1e3, best);
+
+		if (n > 100) return;
+		const float* columns[] = { s.ys.data() };
+		std::vector<float> sigmas = LogSpace(1.f, 100.f, 100);
+		double loo = Seconds([&]() {
+			curve = SweepSigma(s.xs.data(), columns, 1, n, sigmas);
+		});
+		std::snprintf(best, sizeof(best), "%.4g", curve.Best(NAN));
+		std::printf("%-24s %9d %12.4f %12s %12s\n", "LOOCV sigma", n, loo * 1e3, "-", best);
+	}
+
+	void RunStreaming(int count, int k, float lambda, std::mt19937& rng) {
+		const int chunk = 4096;
+		std::uniform_real_distribution<float> xDist(0.f, 1000.f);
+		std::normal_distribution<float> noise(0.f, 5.f);
+		std::vector<float> xs(chunk);
+		std::vector<float> ys(chunk);
+		// Samples are generated chunk by chunk, a stream never exists in memory.
+		auto next = [&]() {
+			for (int i = 0; i < chunk; ++i) {
+				xs[i] = xDist(rng);
+				ys[i] = 300.f + 100.f * std::sin(xs[i] * 0.02f) + noise(rng);
+			}
+		};
+
+		StreamingLSFit stream(k, lambda);
+		double generate = Seconds([&]() {
+			for (int done = 0; done < count; done += chunk) {
+				next();
+			}
+		});
+		double fit = Seconds([&]() {
+			stream.Reset(k);
+			for (int done = 0; done < count; done += chunk) {
+				next();
+				stream.Push(xs.data(), ys.data(), chunk);
+			}
+			sink = stream.Weights()(0);
+		});
+		double ns = std::max(fit - generate, 0.) * 1e9 / stream.Count();
+
+		// Same samples through LSEngine, which keeps all of them.
+		const char* compare = "-";
+		char diff[32];
+		if (count <= (1 << 20)) {
+			std::vector<float> allXs;
+			std::vector<float> allYs;
+			stream.Reset(k);
+			for (int done = 0; done < count; done += chunk) {
+				next();
+				stream.Push(xs.data(), ys.data(), chunk);
+				allXs.insert(allXs.end(), xs.begin(), xs.end());
+				allYs.insert(allYs.end(), ys.begin(), ys.end());
+			}
+			LSEngine engine;
+			engine.SetFitBaseCount(k);
+			engine.SetLambda(lambda);
+			engine.Sync(allXs, allYs);
+			// At k = 10 the normal equations are ill-conditioned and the curves differ
+			// visibly, compare how well each fits the samples instead.
+			auto rms = [&](const Eigen::VectorXf& w) {
+				int n = static_cast<int>(allXs.size());
+				double sum = 0;
+				for (int i = 0; i < n; ++i) {
+					double y = 0;
+					for (int j = k - 1; j >= 0; --j) {
+						y = y * allXs[i] + w(j);
+					}
+					sum += (y - allYs[i]) * (y - allYs[i]);
+				}
+				return std::sqrt(sum / n);
+			};
+			double ratio = rms(stream.Weights()) / rms(engine.Weights().col(0));
+			std::snprintf(diff, sizeof(diff), "%.6f", ratio);
+			compare = diff;
+		}
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "stream k=%d lambda=%g", k, lambda);
+		// Gram matrix, right-hand side and one chunk of rows.
+		long long bytes = (k * k + k + k * 256) * sizeof(double);
+		std::printf("%-24s %11lld %12.2f %12lld %16s\n", name, stream.Count(), ns, bytes, compare);
+	}
+
+	void RunParameterize(const Samples& s) {
+		const char* names[] = { "", "param uniform", "param chordal", "param centripetal" };
+		int n = static_cast<int>(s.xs.size());
+		std::vector<float> ts(n);
+		std::vector<float> xs = s.xs;
+		std::vector<float> ys = s.ys;
+		xs.push_back(s.nextX);
+		ys.push_back(s.nextY);
+		for (int mode = Uniform; mode <= Centripetal; ++mode) {
+			double t = Seconds([&]() {
+				Parameterize(s.xs.data(), s.ys.data(), n, (ParamMode)mode, 30.f, ts.data());
+				sink = ts[n - 1];
+			});
+			// Alternate between n + 1 and n points like Run().
+			ParameterizationCache cache;
+			cache.Sync(s.xs, s.ys, (ParamMode)mode, 30.f);
+			int step = 0;
+			double push = Seconds([&]() {
+				const std::vector<float>& cached = step++ % 2 == 0 ? cache.Sync(xs, ys, (ParamMode)mode, 30.f) : cache.Sync(s.xs, s.ys, (ParamMode)mode, 30.f);
+				sink = cached.back();
+			});
+			std::printf("%-24s %9d %12.4f %12.3f %12s\n", names[mode], n, t * 1e3, push * 1e6, "-");
+		}
+	}
+
+	// The serial loop Parameterize replaced, pow per segment.
+	void SerialParameterize(const float* xs, const float* ys, int count, ParamMode mode, float* ts) {
+		ts[0] = 0;
+		for (int i = 1; i < count; ++i) {
+			float xDiff = xs[i] - xs[i - 1];
+			float yDiff = ys[i] - ys[i - 1];
+			float d2 = xDiff * xDiff + yDiff * yDiff;
+			ts[i] = ts[i - 1] + (mode == Chordal ? std::sqrt(d2) : std::pow(d2, 0.25f));
+		}
+	}
+
+	void RunLongParameterize(int count, ParamMode mode, std::mt19937& rng) {
+		std::normal_distribution<float> step(0.f, 1.f);
+		std::vector<float> xs(count);
+		std::vector<float> ys(count);
+		for (int i = 1; i < count; ++i) {
+			xs[i] = xs[i - 1] + step(rng);
+			ys[i] = ys[i - 1] + step(rng);
+		}
+		std::vector<float> ts(count);
+		double serial = Seconds([&]() {
+			SerialParameterize(xs.data(), ys.data(), count, mode, ts.data());
+			sink = ts[count - 1];
+		});
+		double shared = Seconds([&]() {
+			Parameterize(xs.data(), ys.data(), count, mode, 30.f, ts.data());
+			sink = ts[count - 1];
+		});
+		std::printf("%-24s %9d %12.4f %12.4f %11.2fx\n", mode == Chordal ? "chordal" : "centripetal", count, serial * 1e3, shared * 1e3, serial / shared);
+	}
+}
+
+int main() {
+	std::mt19937 rng(102);
+
+	std::printf("%-24s %9s %12s %12s %12s\n", "method", "points", "fit ms", "push us", "eval ns");
+	for (int count : { 10, 100, 1000, 10000, 100000, 1000000 }) {
+		Samples s = MakeSamples(count, rng);
+
+		if (count <= 1000) {
+			RunPolynomial<PIEngine>("PI vandermonde", s, [](PIEngine&) {});
+		}
+		if (count <= 10000) {
+			Run<BarycentricEngine>("PI barycentric", s, [](BarycentricEngine&) {}, [&](BarycentricEngine& engine, float* out) {
+				engine.Eval(s.grid.data(), out, EVAL_COUNT);
+			});
+		}
+
+		if (count <= 1000) {
+			auto setup = [](GIEngine& engine) { engine.SetSigma(SIGMA); };
+			Run<GIEngine>("GI dense", s, setup, [&](GIEngine& engine, float* out) {
+				EvalGauss(s.xs.data(), count, SIGMA, engine.Weights().data(), s.grid.data(), out, EVAL_COUNT);
+			});
+			// Build is part of the evaluation, it runs whenever the weights change.
+			Run<GIEngine>("GI fast", s, setup, [&](GIEngine& engine, float* out) {
+				FastGaussTransform fgt;
+				fgt.Build(s.xs.data(), count, engine.Weights().data(), SIGMA, FGT_TOLERANCE);
+				fgt.Eval(s.grid.data(), out, EVAL_COUNT);
+			});
+		}
+		Run<CompactGIEngine>("GI compact", s, [](CompactGIEngine& engine) { engine.SetSigma(SIGMA); }, [&](CompactGIEngine& engine, float* out) {
+			engine.Eval(s.grid.data(), out, EVAL_COUNT);
+		});
+
+		for (int k : { 2, 4, 7, 10 }) {
+			RunPolynomial<LSEngine>("PF k=" + std::to_string(k), s, [k](LSEngine& engine) {
+				engine.SetFitBaseCount(k);
+			});
+		}
+		for (int k : { 4, 10 }) {
+			for (float lambda : { 0.001f, 0.2f }) {
+				char name[64];
+				std::snprintf(name, sizeof(name), "FR k=%d lambda=%g", k, lambda);
+				RunPolynomial<LSEngine>(name, s, [k, lambda](LSEngine& engine) {
+					engine.SetFitBaseCount(k);
+					engine.SetLambda(lambda);
+				});
+			}
+		}
+
+		RunChebyshev("PF chebyshev k=4", s, [](LSEngine& engine) { engine.SetFitBaseCount(4); });
+		RunChebyshev("PF chebyshev k=10", s, [](LSEngine& engine) { engine.SetFitBaseCount(10); });
+		RunChebyshev("FR chebyshev k=10", s, [](LSEngine& engine) {
+			engine.SetFitBaseCount(10);
+			engine.SetLambda(0.2f);
+		});
+
+		for (int knots : { 16, 256 }) {
+			Run<BSplineFitEngine>("BS knots=" + std::to_string(knots), s, [knots](BSplineFitEngine& engine) {
+				engine.SetKnotCount(knots);
+			}, [&](BSplineFitEngine& engine, float* out) {
+				engine.Eval(s.grid.data(), out, EVAL_COUNT);
+			});
+		}
+
+		for (auto [neighbors, degree] : { std::pair<int, int>{ 8, 1 }, { 32, 3 } }) {
+			char name[64];
+			std::snprintf(name, sizeof(name), "MLS k=%d degree=%d", neighbors, degree);
+			Run<MLSEngine>(name, s, [neighbors, degree](MLSEngine& engine) {
+				engine.SetNeighborCount(neighbors);
+				engine.SetDegree(degree);
+			}, [&](MLSEngine& engine, float* out) {
+				engine.Eval(s.grid.data(), out, EVAL_COUNT);
+			});
+		}
+
+		RunParameterize(s);
+		std::printf("\n");
+	}
+
+	std::printf("%-24s %9s %12s %12s %12s\n", "parameterization", "points", "serial ms", "shared ms", "speedup");
+	for (int count : { 1 << 16, 1 << 20, 1 << 23 }) {
+		RunLongParameterize(count, Chordal, rng);
+		RunLongParameterize(count, Centripetal, rng);
+	}
+	std::printf("\n");
+
+	// Evaluation error only, the fit itself is shared by both evaluations.
+	std::printf("%-24s %9s %12s %12s\n", "float eval error", "points", "monomial", "chebyshev");
+	for (int count : { 100, 1000, 10000 }) {
+		Samples s = MakeSamples(count, rng);
+		for (int k : { 4, 7, 10 }) {
+			RunBasisAccuracy(s, k);
+		}
+	}
+	std::printf("\n");
+
+	std::printf("%-24s %11s %12s %12s %16s\n", "streaming PF/FR", "samples", "ns/sample", "state bytes", "rms / LSEngine");
+	for (int count : { 1 << 20, 1 << 24 }) {
+		RunStreaming(count, 4, 0.f, rng);
+		RunStreaming(count, 10, 0.f, rng);
+		RunStreaming(count, 10, 0.2f, rng);
+	}
+	std::printf("\n");
+
+	std::printf("%-24s %9s %12s %12s %12s\n", "auto tune", "points", "sweep ms", "refit ms", "best");
+	for (int count : { 100, 1000, 100000, 1000000 }) {
+		RunTune(MakeSamples(count, rng));
+	}
+	std::printf("\n");
+
+	std::printf("%-24s %9s %12s %12s %12s\n", "curve (x, y) over t", "points", "2 fits ms", "shared ms", "speedup");
+	for (int count : { 100, 1000, 10000, 100000 }) {
+		Samples s = MakeSamples(count, rng);
+		if (count <= 1000) {
+			RunCurve<PIEngine>("PI vandermonde", s, [](PIEngine&) {});
+			RunCurve<GIEngine>("GI dense", s, [](GIEngine& engine) { engine.SetSigma(SIGMA); });
+		}
+		RunCurve<CompactGIEngine>("GI compact", s, [](CompactGIEngine& engine) { engine.SetSigma(SIGMA); });
+		RunCurve<LSEngine>("PF k=4", s, [](LSEngine& engine) { engine.SetFitBaseCount(4); });
+		RunCurve<LSEngine>("FR k=10 lambda=0.2", s, [](LSEngine& engine) {
+			engine.SetFitBaseCount(10);
+			engine.SetLambda(0.2f);
+		});
+		RunCurve<BSplineFitEngine>("BS knots=64", s, [](BSplineFitEngine& engine) { engine.SetKnotCount(64); });
+		std::printf("\n");
+	}
+	return 0;
+}
@@ -0,0 +1,83 @@
+// Microbenchmark of the polynomial evaluation used by PI/PF/FR predictions:
+// the per-term pow() loop FittingSystem.cpp used before, against the batched
+// Horner evaluator in src/hw1/Fitting/PolynomialEval.
+#include "PolynomialEval.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+	// Previous PolynomialSolver, one pow per term and sample.
+	float PowSolver(float x, const std::vector<float>& coeffs) {
+		float y = 0;
+		int count = static_cast<int>(coeffs.size());
+		for (int i = 0; i < count; ++i) {
+			y += coeffs[i] * pow(x, i);
+		}
+		return y;
+	}
+
+	template<typename F>
+	double NanosecondsPerSample(int count, F&& f) {
+		using Clock = std::chrono::steady_clock;
+		int repeat = 0;
+		Clock::duration elapsed{};
+		Clock::time_point begin = Clock::now();
+		do {
+			f();
+			++repeat;
+			elapsed = Clock::now() - begin;
+		} while (elapsed < std::chrono::milliseconds(200));
+		return std::chrono::duration<double, std::nano>(elapsed).count() / (double(repeat) * count);
+	}
+
+	volatile float sink;
+}
+
+int main() {
+	std::mt19937 rng(102);
+	const float left = 0;
+	const float right = 1000;
+
+	std::printf("%8s %10s %14s %16s %9s %12s\n", "degree", "samples", "pow ns/sample", "batch ns/sample", "speedup", "max |diff|");
+	for (int coeffCount : { 3, 5, 10 }) {
+		// Keep every term around the same magnitude on [0, 1000].
+		std::vector<float> coeffs(coeffCount);
+		std::uniform_real_distribution<float> dist(-1.f, 1.f);
+		for (int j = 0; j < coeffCount; ++j) {
+			coeffs[j] = dist(rng) * std::pow(1000.f, -float(j)) * 100.f;
+		}
+
+		for (int count : { 1000, 100000, 1000000 }) {
+			float delta = (right - left) / count;
+			std::vector<float> powYs(count);
+			std::vector<float> batchYs(count);
+
+			double powNs = NanosecondsPerSample(count, [&]() {
+				float x = left;
+				for (int i = 0; i < count; ++i) {
+					x = std::min(x, right);
+					powYs[i] = PowSolver(x, coeffs);
+					x += delta;
+				}
+				sink = powYs[count / 2];
+			});
+			double batchNs = NanosecondsPerSample(count, [&]() {
+				EvalPolynomialRange(coeffs.data(), coeffCount, left, right, delta, batchYs.data(), count);
+				sink = batchYs[count / 2];
+			});
+
+			// Both paths sample the same abscissas up to the rounding of x += delta.
+			float maxDiff = 0;
+			for (int i = 0; i < count; ++i) {
+				maxDiff = std::max(maxDiff, std::abs(batchYs[i] - PowSolver(std::min(left + i * delta, right), coeffs)));
+			}
+			std::printf("%8d %10d %14.3f %16.3f %8.1fx %12.3g\n", coeffCount - 1, count, powNs, batchNs, powNs / batchNs, maxDiff);
+		}
+	}
+	return 0;
+}
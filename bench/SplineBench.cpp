@@ -0,0 +1,493 @@
+// Throughput of the hw4 spline kernels (GAMES102_Spline), without ImGui or
+// Utopia. For every knot count it reports
+//   1 column ms   natural spline moments of y over t
+//   x, y ms       both columns of a curve with one shared elimination
+//   max error     against a dense solve of the same system, small counts only
+// the clamped and periodic (closed loop) end conditions
+//   x, y ms       both columns, the cyclic system costs two Thomas solves
+//   max error     against a dense solve, small counts only
+// and the latency of dragging one knot with IncrementalSpline
+//   drag ms       one Update() after the knot moved
+//   full ms       re-solving every moment instead
+//   curve error   largest bend of a piece against the full solve, delta * h^2 / 8
+// and sampling a solved spline uniformly, 1e6 samples
+//   moment ms     the moment form per sample, pieces walked forward
+//   power ms      SplineCoefficients::EvalUniform
+//   moment/power error  against the moment form in double
+//   query ns      one Eval() at a random t, binary search
+// and sampling a curve at equal arc length, 4 units apart
+//   build ms      ArcLengthTable over every piece
+//   update us     one dragged knot, its 16 pieces integrated again
+//   arc samples   points at equal arc length
+//   t samples     points at uniform t no farther apart, dt = spacing / max speed
+//   max gap       largest distance of two consecutive arc length samples
+// and many short independent tracks, lengths varying from knots / 2 to knots
+//   loop ms       SplineMoments once per track
+//   batch ms      SplineMomentsBatch, interleaved across tracks
+//   max error     between the two
+// and smoothing noisy samples of sin(t), noise sigma 0.1, unit spacing
+//   smooth ms     SmoothingSpline of one column
+//   rms error     of the smoothed values against sin(t), the noise alone is 0.1
+// and nearest point / ray queries on a curve through SplineBVH, 100 random points
+//   build ms      boxes of every piece and the tree above them
+//   refit us      one dragged knot, its 16 pieces and their ancestors
+//   nearest us    one SplineBVH::Nearest
+//   brute us      closest of 16 samples per piece, the drawn polyline
+//   ray us        one SplineBVH::Raycast in a random direction
+//   misses        queries where the brute force found a closer point
+#include "ArcLength.h"
+#include "SplineBatch.h"
+#include "SplineBVH.h"
+#include "SplineEval.h"
+#include "SmoothingSpline.h"
+#include "SplineSolver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+#include "Eigen/Dense"
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	// Average seconds of f, repeated for at least 100ms unless one call is longer.
+	double Seconds(const std::function<void()>& f) {
+		int repeat = 0;
+		Clock::duration elapsed{};
+		Clock::time_point begin = Clock::now();
+		do {
+			f();
+			++repeat;
+			elapsed = Clock::now() - begin;
+		} while (elapsed < std::chrono::milliseconds(100));
+		return std::chrono::duration<double>(elapsed).count() / repeat;
+	}
+
+	volatile float sink;
+
+	struct Knots {
+		std::vector<float> ts;
+		std::vector<float> xs;
+		std::vector<float> ys;
+	};
+
+	// A random walk parameterized by chord length, like a long hand drawn curve.
+	// Moment form of piece [xc, xn], how hw4 evaluated before the coefficient cache.
+	float MomentForm(float mc, float mn, float xc, float xn, float yc, float yn, float x) {
+		float hc = xn - xc;
+		float invHc = 1 / hc;
+		float xnDiff = xn - x;
+		float xcDiff = x - xc;
+		return mc * invHc / 6 * xnDiff * xnDiff * xnDiff
+			+ mn * invHc / 6 * xcDiff * xcDiff * xcDiff
+			+ xcDiff * (yn * invHc - mn * hc / 6)
+			+ xnDiff * (yc * invHc - mc * hc / 6);
+	}
+
+	Knots MakeKnots(int count, std::mt19937& rng) {
+		std::normal_distribution<float> step(0.f, 10.f);
+		Knots k;
+		k.ts.resize(count);
+		k.xs.resize(count);
+		k.ys.resize(count);
+		double t = 0;
+		for (int i = 1; i < count; ++i) {
+			k.xs[i] = k.xs[i - 1] + step(rng);
+			k.ys[i] = k.ys[i - 1] + step(rng);
+			t += std::hypot(k.xs[i] - k.xs[i - 1], k.ys[i] - k.ys[i - 1]);
+			// Far from 0 a short segment rounds to no length in float, keep the knots apart.
+			k.ts[i] = std::max(static_cast<float>(t), std::nextafter(k.ts[i - 1], INFINITY));
+		}
+		return k;
+	}
+
+	// Dense reference of the natural spline system.
+	double MaxDenseError(const Knots& k, const std::vector<float>& moments) {
+		int n = static_cast<int>(k.ts.size()) - 2;
+		Eigen::MatrixXd a = Eigen::MatrixXd::Zero(n, n);
+		Eigen::VectorXd r(n);
+		for (int i = 0; i < n; ++i) {
+			double hc = k.ts[i + 1] - k.ts[i];
+			double hn = k.ts[i + 2] - k.ts[i + 1];
+			if (i > 0) a(i, i - 1) = hc;
+			if (i < n - 1) a(i, i + 1) = hn;
+			a(i, i) = 2 * (hc + hn);
+			r(i) = 6 * ((k.ys[i + 2] - k.ys[i + 1]) / hn - (k.ys[i + 1] - k.ys[i]) / hc);
+		}
+		Eigen::VectorXd m = a.partialPivLu().solve(r);
+		double error = 0;
+		for (int i = 0; i < n; ++i) {
+			error = std::max(error, std::abs(m(i) - moments[i + 1]) / std::max(1., std::abs(m(i))));
+		}
+		return error;
+	}
+
+	// Dense reference of the clamped (end chord slopes) and periodic systems.
+	double MaxDenseError(const Knots& k, SplineBoundary boundary, const std::vector<float>& moments) {
+		int count = static_cast<int>(k.ts.size());
+		int n = boundary == Periodic ? count - 1 : count;
+		auto h = [&](int i) { return double(k.ts[i + 1]) - k.ts[i]; };
+		auto d = [&](int i) { return (double(k.ys[i + 1]) - k.ys[i]) / h(i); };
+		Eigen::MatrixXd a = Eigen::MatrixXd::Zero(n, n);
+		Eigen::VectorXd r = Eigen::VectorXd::Zero(n);
+		for (int i = 0; i < n; ++i) {
+			if (boundary == Clamped && (i == 0 || i == n - 1)) {
+				int j = i == 0 ? 0 : n - 2;
+				a(i, i) = 2 * h(j);
+				a(i, i == 0 ? 1 : n - 2) = h(j);
+				continue;
+			}
+			int prev = (i + n - 1) % n;
+			a(i, prev) += h(prev);
+			a(i, i) += 2 * (h(prev) + h(i));
+			a(i, (i + 1) % n) += h(i);
+			r(i) = 6 * (d(i) - d(prev));
+		}
+		Eigen::VectorXd m = a.partialPivLu().solve(r);
+		double error = 0;
+		for (int i = 0; i < n; ++i) {
+			error = std::max(error, std::abs(m(i) - moments[i]) / std::max(1., std::abs(m(i))));
+		}
+		return error;
+	}
+
+	// Close the walk into a loop, the last knot repeats the first one.
+	void CloseKnots(Knots& k) {
+		float x = k.xs.front();
+		float y = k.ys.front();
+		float t = k.ts.back() + std::max(std::hypot(x - k.xs.back(), y - k.ys.back()), 1e-3f);
+		k.xs.push_back(x);
+		k.ys.push_back(y);
+		k.ts.push_back(t);
+	}
+}
+
+int main() {
+	std::mt19937 rng(102);
+
+	std::printf("%-12s %12s %12s %12s\n", "knots", "1 column ms", "x, y ms", "max error");
+	for (int count : { 1000, 10000, 100000, 1000000, 4000000 }) {
+		Knots k = MakeKnots(count, rng);
+		std::vector<float> xm(count);
+		std::vector<float> ym(count);
+
+		double one = Seconds([&]() {
+			SplineMoments(k.ts.data(), k.ys.data(), count, ym.data());
+			sink = ym[count / 2];
+		});
+		const float* columns[] = { k.xs.data(), k.ys.data() };
+		float* moments[] = { xm.data(), ym.data() };
+		double both = Seconds([&]() {
+			SplineMoments(k.ts.data(), columns, 2, count, moments);
+			sink = xm[count / 2] + ym[count / 2];
+		});
+
+		char error[32] = "-";
+		if (count <= 1000) {
+			std::snprintf(error, sizeof(error), "%.3g", MaxDenseError(k, ym));
+		}
+		std::printf("%-12d %12.4f %12.4f %12s\n", count, one * 1e3, both * 1e3, error);
+	}
+
+	std::printf("\n%-12s %-10s %12s %12s\n", "knots", "ends", "x, y ms", "max error");
+	for (int count : { 1000, 10000, 100000, 1000000, 4000000 }) {
+		for (SplineBoundary boundary : { Clamped, Periodic }) {
+			Knots k = MakeKnots(count, rng);
+			if (boundary == Periodic) CloseKnots(k);
+			int knots = static_cast<int>(k.ts.size());
+			std::vector<float> xm(knots);
+			std::vector<float> ym(knots);
+			const float* columns[] = { k.xs.data(), k.ys.data() };
+			float* moments[] = { xm.data(), ym.data() };
+			double both = Seconds([&]() {
+				SplineMoments(k.ts.data(), columns, 2, knots, moments, boundary);
+				sink = xm[count / 2] + ym[count / 2];
+			});
+			char error[32] = "-";
+			if (count <= 1000) {
+				std::snprintf(error, sizeof(error), "%.3g", MaxDenseError(k, boundary, ym));
+			}
+			std::printf("%-12d %-10s %12.4f %12s\n", count, boundary == Clamped ? "clamped" : "periodic", both * 1e3, error);
+		}
+	}
+
+	std::printf("\n%-12s %12s %12s %12s\n", "knots", "drag ms", "full ms", "curve error");
+	const float tolerance = 0.05f;
+	for (int count : { 1000, 10000, 100000, 1000000, 4000000 }) {
+		Knots k = MakeKnots(count, rng);
+		const float* columns[] = { k.xs.data(), k.ys.data() };
+		IncrementalSpline spline;
+		spline.Solve(k.ts.data(), columns, 2, count);
+
+		// Drag the middle knot back and forth, the parameters after it shift like
+		// ParameterizationCache leaves them.
+		int index = count / 2;
+		int step = 0;
+		auto move = [&]() {
+			float offset = (step++ % 2 == 0 ? 1.f : -1.f) * 3.f;
+			k.xs[index] += offset;
+			k.ys[index] -= offset;
+		};
+		double drag = Seconds([&]() {
+			move();
+			auto range = spline.Update(k.ts.data(), columns, index, tolerance);
+			sink = static_cast<float>(range.second - range.first);
+		});
+		double full = Seconds([&]() {
+			move();
+			IncrementalSpline reference;
+			reference.Solve(k.ts.data(), columns, 2, count);
+			sink = reference.Moments(0)[index];
+		});
+
+		// One more drag from a clean solve, then compare with the exact moments.
+		spline.Solve(k.ts.data(), columns, 2, count);
+		move();
+		spline.Update(k.ts.data(), columns, index, tolerance);
+		IncrementalSpline reference;
+		reference.Solve(k.ts.data(), columns, 2, count);
+		double curveError = 0;
+		for (int d = 0; d < 2; ++d) {
+			for (int i = 0; i < count; ++i) {
+				float h = std::max(i > 0 ? k.ts[i] - k.ts[i - 1] : 0.f, i < count - 1 ? k.ts[i + 1] - k.ts[i] : 0.f);
+				curveError = std::max(curveError, std::abs(double(spline.Moments(d)[i]) - reference.Moments(d)[i]) * h * h / 8);
+			}
+		}
+		std::printf("%-12d %12.4f %12.4f %12.3g\n", count, drag * 1e3, full * 1e3, curveError);
+	}
+
+	std::printf("\n%-12s %12s %12s %12s %12s %12s\n", "knots", "moment ms", "power ms", "moment error", "power error", "query ns");
+	const int samples = 1000000;
+	for (int count : { 100, 10000, 1000000 }) {
+		Knots k = MakeKnots(count, rng);
+		std::vector<float> ym(count);
+		SplineMoments(k.ts.data(), k.ys.data(), count, ym.data());
+		SplineCoefficients coeffs;
+		coeffs.Build(k.ts.data(), k.ys.data(), ym.data(), count);
+
+		float t0 = k.ts.front();
+		float step = (k.ts.back() - t0) / samples;
+		std::vector<float> moment(samples);
+		std::vector<float> power(samples);
+		double momentTime = Seconds([&]() {
+			int i = 0;
+			for (int j = 0; j < samples; ++j) {
+				float t = t0 + j * step;
+				while (i < count - 2 && t >= k.ts[i + 1]) ++i;
+				moment[j] = MomentForm(ym[i], ym[i + 1], k.ts[i], k.ts[i + 1], k.ys[i], k.ys[i + 1], t);
+			}
+			sink = moment[samples / 2];
+		});
+		double powerTime = Seconds([&]() {
+			coeffs.EvalUniform(t0, step, power.data(), samples);
+			sink = power[samples / 2];
+		});
+		double momentError = 0;
+		double powerError = 0;
+		int i = 0;
+		for (int j = 0; j < samples; ++j) {
+			double t = t0 + double(j) * step;
+			while (i < count - 2 && t >= k.ts[i + 1]) ++i;
+			double hc = double(k.ts[i + 1]) - k.ts[i];
+			double xn = k.ts[i + 1] - t;
+			double xc = t - k.ts[i];
+			double y = (ym[i] * xn * xn * xn + ym[i + 1] * xc * xc * xc) / (6 * hc)
+				+ xc * (k.ys[i + 1] / hc - ym[i + 1] * hc / 6)
+				+ xn * (k.ys[i] / hc - ym[i] * hc / 6);
+			double scale = std::max(1., std::abs(y));
+			momentError = std::max(momentError, std::abs(moment[j] - y) / scale);
+			powerError = std::max(powerError, std::abs(power[j] - y) / scale);
+		}
+
+		std::uniform_real_distribution<float> at(k.ts.front(), k.ts.back());
+		std::vector<float> queries(4096);
+		for (float& q : queries) q = at(rng);
+		double queryTime = Seconds([&]() {
+			float sum = 0;
+			for (float q : queries) sum += coeffs.Eval(q);
+			sink = sum;
+		}) / queries.size();
+		std::printf("%-12d %12.4f %12.4f %12.3g %12.3g %12.1f\n", count, momentTime * 1e3, powerTime * 1e3, momentError, powerError, queryTime * 1e9);
+	}
+
+	std::printf("\n%-12s %12s %12s %12s %12s %12s\n", "knots", "build ms", "update us", "arc samples", "t samples", "max gap");
+	const float spacing = 4.f;
+	for (int count : { 100, 10000, 100000 }) {
+		Knots k = MakeKnots(count, rng);
+		std::vector<float> xm(count);
+		std::vector<float> ym(count);
+		const float* columns[] = { k.xs.data(), k.ys.data() };
+		float* moments[] = { xm.data(), ym.data() };
+		SplineMoments(k.ts.data(), columns, 2, count, moments);
+		SplineCoefficients x;
+		SplineCoefficients y;
+		x.Build(k.ts.data(), k.xs.data(), xm.data(), count);
+		y.Build(k.ts.data(), k.ys.data(), ym.data(), count);
+
+		ArcLengthTable table;
+		double build = Seconds([&]() {
+			table.Build(x, y);
+			sink = static_cast<float>(table.Length());
+		});
+		int middle = count / 2;
+		double update = Seconds([&]() {
+			table.Update(x, y, middle - 8, middle + 7);
+			sink = static_cast<float>(table.Length());
+		});
+
+		std::vector<float> ts;
+		std::vector<int> pieces;
+		table.EqualSpaced(x, y, spacing, ts, pieces);
+		double gap = 0;
+		for (size_t j = 1; j < ts.size(); ++j) {
+			float dx = x.EvalPiece(pieces[j], ts[j]) - x.EvalPiece(pieces[j - 1], ts[j - 1]);
+			float dy = y.EvalPiece(pieces[j], ts[j]) - y.EvalPiece(pieces[j - 1], ts[j - 1]);
+			gap = std::max(gap, double(std::hypot(dx, dy)));
+		}
+		// Uniform t keeps every gap below spacing only with dt from the fastest point.
+		double maxSpeed = 0;
+		for (int i = 0; i < count - 1; ++i) {
+			for (int j = 0; j <= 16; ++j) {
+				float t = k.ts[i] + (k.ts[i + 1] - k.ts[i]) * j / 16;
+				maxSpeed = std::max(maxSpeed, double(std::hypot(x.DerivativePiece(i, t), y.DerivativePiece(i, t))));
+			}
+		}
+		double tSamples = std::ceil((k.ts.back() - k.ts.front()) * maxSpeed / spacing) + 1;
+		std::printf("%-12d %12.4f %12.3f %12zu %12.0f %12.4f\n", count, build * 1e3, update * 1e6, ts.size(), tSamples, gap);
+	}
+
+	std::printf("\n%-12s %-12s %12s %12s %12s\n", "tracks", "knots", "loop ms", "batch ms", "max error");
+	for (auto [tracks, stride] : { std::pair<int, int>{ 1000, 16 }, { 10000, 32 }, { 100000, 16 }, { 2000, 256 } }) {
+		std::vector<float> ts(tracks * stride);
+		std::vector<float> ys(tracks * stride);
+		std::vector<int> counts(tracks);
+		std::uniform_int_distribution<int> length(stride / 2, stride);
+		for (int c = 0; c < tracks; ++c) {
+			Knots k = MakeKnots(stride, rng);
+			std::copy(k.ts.begin(), k.ts.end(), ts.begin() + c * stride);
+			std::copy(k.ys.begin(), k.ys.end(), ys.begin() + c * stride);
+			counts[c] = length(rng);
+		}
+		std::vector<float> loop(tracks * stride);
+		std::vector<float> batch(tracks * stride);
+		double loopTime = Seconds([&]() {
+			for (int c = 0; c < tracks; ++c) {
+				SplineMoments(ts.data() + c * stride, ys.data() + c * stride, counts[c], loop.data() + c * stride);
+			}
+			sink = loop[stride / 2];
+		});
+		double batchTime = Seconds([&]() {
+			SplineMomentsBatch(ts.data(), ys.data(), counts.data(), stride, tracks, batch.data());
+			sink = batch[stride / 2];
+		});
+		double error = 0;
+		for (int c = 0; c < tracks; ++c) {
+			for (int i = 0; i < counts[c]; ++i) {
+				float m = loop[c * stride + i];
+				error = std::max(error, double(std::abs(m - batch[c * stride + i])) / std::max(1.f, std::abs(m)));
+			}
+		}
+		std::printf("%-12d %-12d %12.4f %12.4f %12.3g\n", tracks, stride, loopTime * 1e3, batchTime * 1e3, error);
+	}
+
+	std::printf("\n%-12s %-12s %12s %12s\n", "samples", "lambda", "smooth ms", "rms error");
+	for (int count : { 1000, 100000, 1000000 }) {
+		std::normal_distribution<float> noise(0.f, 0.1f);
+		std::vector<float> ts(count);
+		std::vector<float> ys(count);
+		for (int i = 0; i < count; ++i) {
+			// Slow enough that unit spacing samples it densely.
+			ts[i] = static_cast<float>(i);
+			ys[i] = std::sin(ts[i] * 0.01f) + noise(rng);
+		}
+		std::vector<float> values(count);
+		std::vector<float> moments(count);
+		for (float lambda : { 0.f, 1e3f, 1e5f }) {
+			double smooth = Seconds([&]() {
+				SmoothingSpline(ts.data(), ys.data(), count, lambda, values.data(), moments.data());
+				sink = values[count / 2];
+			});
+			double sum = 0;
+			for (int i = 0; i < count; ++i) {
+				double e = values[i] - std::sin(ts[i] * 0.01);
+				sum += e * e;
+			}
+			std::printf("%-12d %-12g %12.4f %12.4f\n", count, lambda, smooth * 1e3, std::sqrt(sum / count));
+		}
+	}
+
+	std::printf("\n%-12s %12s %12s %12s %12s %12s %12s\n", "knots", "build ms", "refit us", "nearest us", "brute us", "ray us", "misses");
+	for (int count : { 100, 10000, 100000 }) {
+		Knots k = MakeKnots(count, rng);
+		std::vector<float> xm(count);
+		std::vector<float> ym(count);
+		const float* columns[] = { k.xs.data(), k.ys.data() };
+		float* moments[] = { xm.data(), ym.data() };
+		SplineMoments(k.ts.data(), columns, 2, count, moments);
+		SplineCoefficients x;
+		SplineCoefficients y;
+		x.Build(k.ts.data(), k.xs.data(), xm.data(), count);
+		y.Build(k.ts.data(), k.ys.data(), ym.data(), count);
+
+		SplineBVH bvh;
+		double build = Seconds([&]() {
+			bvh.Build(x, y);
+			sink = static_cast<float>(bvh.PieceCount());
+		});
+		int middle = count / 2;
+		double refit = Seconds([&]() {
+			bvh.Refit(x, y, middle - 8, middle + 7);
+			sink = static_cast<float>(bvh.PieceCount());
+		});
+
+		// Query points around the knots, a few steps off the curve.
+		std::vector<float> px(100);
+		std::vector<float> py(100);
+		std::vector<float> angles(100);
+		std::uniform_int_distribution<int> knot(0, count - 1);
+		std::normal_distribution<float> offset(0.f, 10.f);
+		std::uniform_real_distribution<float> angle(0.f, 6.2831853f);
+		for (size_t q = 0; q < px.size(); ++q) {
+			int i = knot(rng);
+			px[q] = k.xs[i] + offset(rng);
+			py[q] = k.ys[i] + offset(rng);
+			angles[q] = angle(rng);
+		}
+		std::vector<CurveHit> hits(px.size());
+		double nearest = Seconds([&]() {
+			for (size_t q = 0; q < px.size(); ++q) {
+				hits[q] = bvh.Nearest(x, y, px[q], py[q]);
+			}
+			sink = hits[0].distance;
+		}) / px.size();
+		std::vector<float> bruteDistance(px.size());
+		double brute = Seconds([&]() {
+			for (size_t q = 0; q < px.size(); ++q) {
+				float best = INFINITY;
+				for (int i = 0; i < count - 1; ++i) {
+					for (int j = 0; j < 16; ++j) {
+						float t = k.ts[i] + (k.ts[i + 1] - k.ts[i]) * j / 16;
+						best = std::min(best, std::hypot(x.EvalPiece(i, t) - px[q], y.EvalPiece(i, t) - py[q]));
+					}
+				}
+				bruteDistance[q] = best;
+			}
+			sink = bruteDistance[0];
+		}) / px.size();
+		double ray = Seconds([&]() {
+			for (size_t q = 0; q < px.size(); ++q) {
+				sink = bvh.Raycast(x, y, px[q], py[q], std::cos(angles[q]), std::sin(angles[q])).distance;
+			}
+		}) / px.size();
+		int misses = 0;
+		for (size_t q = 0; q < px.size(); ++q) {
+			if (hits[q].distance > bruteDistance[q] + 1e-3f) ++misses;
+		}
+		std::printf("%-12d %12.4f %12.3f %12.3f %12.1f %12.3f %12d\n", count, build * 1e3, refit * 1e6, nearest * 1e6, brute * 1e6, ray * 1e6, misses);
+	}
+	return 0;
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "TaskPool.h"
+
+#if !defined(FITTING_NO_SIMD) && defined(__AVX2__)
+#define PARAMETERIZATION_AVX2
+#include <immintrin.h>
+#elif !defined(FITTING_NO_SIMD) && defined(__aarch64__)
+#define PARAMETERIZATION_NEON
+#include <arm_neon.h>
+#endif
+
+// Parameterization of a polyline, shared by the homework systems.
+// Segment lengths are computed with SIMD (AVX2 / NEON, scalar otherwise), the
+// cumulative sum is a two pass prefix scan over blocks on the TaskPool for
+// long polylines. Partial sums are kept in double, so millions of points do
+// not drift. ParameterizationCache only redoes the points after the first
+// changed one, appending a point costs one segment plus the diff.
+
+enum ParamMode {
+	Uniform = 1,
+	Chordal, // Radian length
+	Centripetal,  // Sqrt radian length
+};
+
+namespace ParameterizationDetail {
+	// Polylines shorter than this are scanned by the calling thread.
+	constexpr int PARALLEL_MIN = 1 << 16;
+	// Blocks per thread, evens out uneven workers.
+	constexpr int BLOCKS_PER_THREAD = 4;
+
+	inline float Length(float xDiff, float yDiff, ParamMode mode) {
+		float d = std::sqrt(xDiff * xDiff + yDiff * yDiff);
+		return mode == Centripetal ? std::sqrt(d) : d;
+	}
+
+	// lengths[i] = length of segment (first + i, first + i + 1), i in [0, count)
+	inline void SegmentLengths(const float* xs, const float* ys, int first, int count, ParamMode mode, float* lengths) {
+		const float* x = xs + first;
+		const float* y = ys + first;
+		int i = 0;
+#if defined(PARAMETERIZATION_AVX2)
+		for (; i + 8 <= count; i += 8) {
+			__m256 xDiff = _mm256_sub_ps(_mm256_loadu_ps(x + i + 1), _mm256_loadu_ps(x + i));
+			__m256 yDiff = _mm256_sub_ps(_mm256_loadu_ps(y + i + 1), _mm256_loadu_ps(y + i));
+			__m256 d = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(xDiff, xDiff), _mm256_mul_ps(yDiff, yDiff)));
+			if (mode == Centripetal) d = _mm256_sqrt_ps(d);
+			_mm256_storeu_ps(lengths + i, d);
+		}
+#elif defined(PARAMETERIZATION_NEON)
+		for (; i + 4 <= count; i += 4) {
+			float32x4_t xDiff = vsubq_f32(vld1q_f32(x + i + 1), vld1q_f32(x + i));
+			float32x4_t yDiff = vsubq_f32(vld1q_f32(y + i + 1), vld1q_f32(y + i));
+			float32x4_t d = vsqrtq_f32(vaddq_f32(vmulq_f32(xDiff, xDiff), vmulq_f32(yDiff, yDiff)));
+			if (mode == Centripetal) d = vsqrtq_f32(d);
+			vst1q_f32(lengths + i, d);
+		}
+#endif
+		for (; i < count; ++i) {
+			lengths[i] = Length(x[i + 1] - x[i], y[i + 1] - y[i], mode);
+		}
+	}
+
+	// ts[i] = ts[i - 1] + lengths, ts[i] holds the length of segment i - 1 on entry.
+	inline double ScanInPlace(float* ts, int count, double offset) {
+		for (int i = 0; i < count; ++i) {
+			offset += ts[i];
+			ts[i] = static_cast<float>(offset);
+		}
+		return offset;
+	}
+}
+
+// ts[i] for i in (first, count), ts[first] must be set already.
+inline void ParameterizeFrom(const float* xs, const float* ys, int first, int count, ParamMode mode, float tInterval, float* ts) {
+	using namespace ParameterizationDetail;
+	int segments = count - first - 1;
+	if (segments <= 0) return;
+
+	if (mode == Uniform) {
+		for (int i = 1; i <= segments; ++i) {
+			ts[first + i] = ts[first] + i * tInterval;
+		}
+		return;
+	}
+	if (mode != Chordal && mode != Centripetal) {
+		std::fill(ts + first + 1, ts + count, ts[first]);
+		return;
+	}
+
+	// The lengths are written in place of the parameters and scanned afterwards.
+	float* out = ts + first + 1;
+	TaskPool& pool = TaskPool::Instance();
+	if (segments < PARALLEL_MIN || pool.WorkerCount() == 0) {
+		SegmentLengths(xs, ys, first, segments, mode, out);
+		ScanInPlace(out, segments, ts[first]);
+		return;
+	}
+
+	int blockCount = (pool.WorkerCount() + 1) * BLOCKS_PER_THREAD;
+	int blockSize = (segments + blockCount - 1) / blockCount;
+	blockCount = (segments + blockSize - 1) / blockSize;
+	std::vector<double> sums(blockCount + 1, 0.);
+	// Pass 1: lengths and the total of every block.
+	pool.ParallelFor(blockCount, [&](int b) {
+		int begin = b * blockSize;
+		int size = std::min(blockSize, segments - begin);
+		SegmentLengths(xs, ys, first + begin, size, mode, out + begin);
+		double sum = 0;
+		for (int i = 0; i < size; ++i) {
+			sum += out[begin + i];
+		}
+		sums[b + 1] = sum;
+	});
+	sums[0] = ts[first];
+	for (int b = 1; b <= blockCount; ++b) {
+		sums[b] += sums[b - 1];
+	}
+	// Pass 2: every block scans from its offset.
+	pool.ParallelFor(blockCount, [&](int b) {
+		int begin = b * blockSize;
+		ScanInPlace(out + begin, std::min(blockSize, segments - begin), sums[b]);
+	});
+}
+
+// ts[i] parameter of (xs[i], ys[i]) along the polyline, ts[0] = 0
+inline void Parameterize(const float* xs, const float* ys, int count, ParamMode mode, float tInterval, float* ts) {
+	if (count < 1) return;
+	ts[0] = 0;
+	ParameterizeFrom(xs, ys, 0, count, mode, tInterval, ts);
+}
+
+// Keep the parameters of the last polyline. Sync() diffs the points against
+// the cached ones like IncrementalFit does, only the parameters after the
+// first changed point are recomputed.
+class ParameterizationCache {
+public:
+	const std::vector<float>& Sync(const float* newXs, const float* newYs, int count, ParamMode newMode, float newTInterval) {
+		int first = 0;
+		if (newMode == mode && newTInterval == tInterval) {
+			int common = std::min(count, static_cast<int>(xs.size()));
+			while (first < common && xs[first] == newXs[first] && ys[first] == newYs[first]) {
+				++first;
+			}
+		}
+		mode = newMode;
+		tInterval = newTInterval;
+		xs.resize(count);
+		ys.resize(count);
+		std::copy(newXs + first, newXs + count, xs.begin() + first);
+		std::copy(newYs + first, newYs + count, ys.begin() + first);
+		ts.resize(count);
+
+		// ts[first - 1] is still valid, continue from there.
+		if (first == 0) {
+			Parameterize(newXs, newYs, count, mode, tInterval, ts.data());
+		}
+		else if (first < count) {
+			ParameterizeFrom(newXs, newYs, first - 1, count, mode, tInterval, ts.data());
+		}
+		return ts;
+	}
+
+	const std::vector<float>& Sync(const std::vector<float>& xs, const std::vector<float>& ys, ParamMode mode, float tInterval) {
+		return Sync(xs.data(), ys.data(), static_cast<int>(std::min(xs.size(), ys.size())), mode, tInterval);
+	}
+
+	const std::vector<float>& Ts() const { return ts; }
+
+private:
+	std::vector<float> xs;
+	std::vector<float> ys;
+	std::vector<float> ts;
+	ParamMode mode{ Uniform };
+	float tInterval{ 0 };
+};
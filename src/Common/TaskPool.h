@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for the homework systems. ParallelFor hands out
+// indices one by one, the calling thread works too and returns when every index
+// is done, so tasks may reference the caller's stack. Tasks must not touch ImGui.
+class TaskPool {
+public:
+	// One worker per hardware thread besides the caller.
+	static TaskPool& Instance() {
+		static TaskPool pool(static_cast<int>(std::thread::hardware_concurrency()) - 1);
+		return pool;
+	}
+
+	explicit TaskPool(int workerCount) {
+		for (int i = 0; i < workerCount; ++i) {
+			workers.emplace_back([this]() { Work(); });
+		}
+	}
+
+	~TaskPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+		}
+		wake.notify_all();
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+	}
+
+	TaskPool(const TaskPool&) = delete;
+	TaskPool& operator=(const TaskPool&) = delete;
+
+	int WorkerCount() const { return static_cast<int>(workers.size()); }
+
+	// f(i) for every i in [0, count).
+	void ParallelFor(int count, const std::function<void(int)>& f) {
+		if (count <= 0) return;
+		// Nested calls run inline, the workers are busy with the outer batch.
+		if (count == 1 || workers.empty() || InTask()) {
+			for (int i = 0; i < count; ++i) f(i);
+			return;
+		}
+
+		// One batch at a time, concurrent callers wait here.
+		std::lock_guard<std::mutex> batchLock(batchMutex);
+		Batch batch{ &f, count };
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			current = &batch;
+		}
+		wake.notify_all();
+
+		Drain(batch);
+
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [&]() { return batch.done == count && active == 0; });
+		current = nullptr;
+	}
+
+private:
+	struct Batch {
+		const std::function<void(int)>* f;
+		int count;
+		std::atomic<int> next{ 0 };
+		std::atomic<int> done{ 0 };
+	};
+
+	static bool& InTask() {
+		static thread_local bool inTask = false;
+		return inTask;
+	}
+
+	static void Drain(Batch& batch) {
+		InTask() = true;
+		for (int i = batch.next++; i < batch.count; i = batch.next++) {
+			(*batch.f)(i);
+			++batch.done;
+		}
+		InTask() = false;
+	}
+
+	void Work() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			wake.wait(lock, [this]() { return quit || (current && current->next < current->count); });
+			if (quit) return;
+
+			Batch* batch = current;
+			++active;
+			lock.unlock();
+			Drain(*batch);
+			lock.lock();
+			--active;
+			finished.notify_all();
+		}
+	}
+
+	std::vector<std::thread> workers;
+	std::mutex batchMutex;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable finished;
+	Batch* current{ nullptr };
+	int active{ 0 };
+	bool quit{ false };
+};
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+// Adaptive tessellation of curves for drawing, shared by the homework systems.
+// A span is bisected only while its midpoint is farther than tolerance (canvas
+// pixels) from the chord, so flat parts cost a few vertices and bends get as
+// many as they need. The result is meant for one ImDrawList::AddPolyline.
+// Point is any 2D type with p[0], p[1] and a (x, y) constructor, e.g. ImVec2
+// or Ubpa::pointf2.
+
+// Distance of p to the segment [a, b]
+template<typename Point>
+float ChordError(const Point& p, const Point& a, const Point& b) {
+	float abX = b[0] - a[0];
+	float abY = b[1] - a[1];
+	float apX = p[0] - a[0];
+	float apY = p[1] - a[1];
+	float length2 = abX * abX + abY * abY;
+	float s = length2 > 0 ? std::clamp((apX * abX + apY * abY) / length2, 0.f, 1.f) : 0.f;
+	float dX = apX - s * abX;
+	float dY = apY - s * abY;
+	return std::sqrt(dX * dX + dY * dY);
+}
+
+// Append the polyline of c over [t0, t1] to out. curve(ts, count, points)
+// writes points[i] = c(ts[i]), every level of bisection is one such batch.
+// The span starts as `segments` uniform pieces, which catches inflections a
+// midpoint test alone misses, and no piece is split below minStep.
+// c(t0) is skipped when out is not empty, so consecutive spans sharing their
+// end points chain into one polyline.
+template<typename Point, typename Curve>
+void Tessellate(Curve&& curve, float t0, float t1, float tolerance, float minStep, int segments, std::vector<Point>& out) {
+	if (!(t1 > t0)) return;
+	if (minStep > 0) {
+		segments = std::min(segments, static_cast<int>((t1 - t0) / minStep));
+	}
+	segments = std::max(segments, 1);
+
+	std::vector<float> ts(segments + 1);
+	for (int i = 0; i < segments; ++i) {
+		ts[i] = t0 + (t1 - t0) * i / segments;
+	}
+	ts[segments] = t1;
+	std::vector<Point> points(segments + 1);
+	curve(ts.data(), segments + 1, points.data());
+	// open[i]: piece [ts[i], ts[i + 1]] may still need a split.
+	std::vector<char> open(segments, 1);
+
+	std::vector<float> midTs;
+	std::vector<Point> mids;
+	std::vector<float> nextTs;
+	std::vector<Point> nextPoints;
+	std::vector<char> nextOpen;
+	while (true) {
+		int pieces = static_cast<int>(ts.size()) - 1;
+		midTs.clear();
+		for (int i = 0; i < pieces; ++i) {
+			if (open[i] && ts[i + 1] - ts[i] >= 2 * minStep) {
+				midTs.push_back(0.5f * (ts[i] + ts[i + 1]));
+			}
+			else {
+				open[i] = 0;
+			}
+		}
+		if (midTs.empty()) break;
+		mids.resize(midTs.size());
+		curve(midTs.data(), static_cast<int>(midTs.size()), mids.data());
+
+		nextTs.clear();
+		nextPoints.clear();
+		nextOpen.clear();
+		int m = 0;
+		for (int i = 0; i < pieces; ++i) {
+			nextTs.push_back(ts[i]);
+			nextPoints.push_back(points[i]);
+			if (!open[i]) {
+				nextOpen.push_back(0);
+				continue;
+			}
+			const Point& mid = mids[m++];
+			if (ChordError(mid, points[i], points[i + 1]) > tolerance) {
+				nextOpen.push_back(1);
+				nextTs.push_back(midTs[m - 1]);
+				nextPoints.push_back(mid);
+				nextOpen.push_back(1);
+			}
+			else {
+				nextOpen.push_back(0);
+			}
+		}
+		nextTs.push_back(ts.back());
+		nextPoints.push_back(points.back());
+		std::swap(ts, nextTs);
+		std::swap(points, nextPoints);
+		std::swap(open, nextOpen);
+	}
+
+	out.insert(out.end(), points.begin() + (out.empty() ? 0 : 1), points.end());
+}
+
+// Append the vertices of a dense polyline that keep every dropped vertex within
+// tolerance of the result (Douglas-Peucker), for curves only known as points.
+template<typename Point>
+void Simplify(const std::vector<Point>& points, float tolerance, std::vector<Point>& out) {
+	int n = static_cast<int>(points.size());
+	if (n <= 2) {
+		out.insert(out.end(), points.begin(), points.end());
+		return;
+	}
+
+	std::vector<char> keep(n, 0);
+	keep[0] = keep[n - 1] = 1;
+	std::vector<std::pair<int, int>> stack{ { 0, n - 1 } };
+	while (!stack.empty()) {
+		auto [first, last] = stack.back();
+		stack.pop_back();
+		int farthest = -1;
+		float error = tolerance;
+		for (int i = first + 1; i < last; ++i) {
+			float e = ChordError(points[i], points[first], points[last]);
+			if (e > error) {
+				error = e;
+				farthest = i;
+			}
+		}
+		if (farthest == -1) continue;
+		keep[farthest] = 1;
+		stack.push_back({ first, farthest });
+		stack.push_back({ farthest, last });
+	}
+
+	for (int i = 0; i < n; ++i) {
+		if (keep[i]) out.push_back(points[i]);
+	}
+}
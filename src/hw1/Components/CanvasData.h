@@ -5,20 +5,35 @@
 struct CanvasData {
 	std::vector<float> xs;
 	std::vector<float> ys;
+	// Bumped whenever xs/ys change, fitted curves are cached against it.
+	int version{ 0 };
 	std::map<std::string, bool> switchs{
 		{"enablePolynomialInterpolate", false},
 		{"enableGaussInterpolate", false},
 		{"enablePolynomialFit", false},
 		{"enableRidgeFit", false},
+		{"enableBSplineFit", false},
+		{"enableMovingLS", false},
 		{"enableCurve", false},
 		{"enableLine", true},
 	};
 
 	int fitBaseCount{ 4 };
 	int paramMode{ 1 };
+	int piMode{ 1 };
+	int giMode{ 1 };
+	// Basis of PF/FR, FitBasis
+	int fitBasis{ 1 };
+	// Uniform knots of the least-squares B-spline
+	int knotCount{ 8 };
+	// Samples and polynomial degree of every moving least squares fit
+	int mlsNeighbors{ 8 };
+	int mlsDegree{ 2 };
 
 	float delta{ 1 };
 	float sigma{ 10.0 };
+	// Error of the fast Gauss transform relative to sum |w|
+	float fgtTolerance{ 1e-4 };
 	float lambda{ 0.2 };
 
 	// Draw Curve(Homework 3)
@@ -15,12 +15,17 @@ struct Ubpa::USRefl::TypeInfo<CanvasData> :
     static constexpr FieldList fields = {
         Field {TSTR("xs"), &Type::xs},
         Field {TSTR("ys"), &Type::ys},
+        Field {TSTR("version"), &Type::version, AttrList {
+            Attr {TSTR(UMeta::initializer), []()->int{ return { 0 }; }},
+        }},
         Field {TSTR("switchs"), &Type::switchs, AttrList {
             Attr {TSTR(UMeta::initializer), []()->std::map<std::string, bool>{ return {
 		{"enablePolynomialInterpolate", false},
 		{"enableGaussInterpolate", false},
 		{"enablePolynomialFit", false},
 		{"enableRidgeFit", false},
+		{"enableBSplineFit", false},
+		{"enableMovingLS", false},
 		{"enableCurve", false},
 		{"enableLine", true},
 	}; }},
@@ -31,12 +36,33 @@ struct Ubpa::USRefl::TypeInfo<CanvasData> :
         Field {TSTR("paramMode"), &Type::paramMode, AttrList {
             Attr {TSTR(UMeta::initializer), []()->int{ return { 1 }; }},
         }},
+        Field {TSTR("piMode"), &Type::piMode, AttrList {
+            Attr {TSTR(UMeta::initializer), []()->int{ return { 1 }; }},
+        }},
+        Field {TSTR("giMode"), &Type::giMode, AttrList {
+            Attr {TSTR(UMeta::initializer), []()->int{ return { 1 }; }},
+        }},
+        Field {TSTR("fitBasis"), &Type::fitBasis, AttrList {
+            Attr {TSTR(UMeta::initializer), []()->int{ return { 1 }; }},
+        }},
+        Field {TSTR("knotCount"), &Type::knotCount, AttrList {
+            Attr {TSTR(UMeta::initializer), []()->int{ return { 8 }; }},
+        }},
+        Field {TSTR("mlsNeighbors"), &Type::mlsNeighbors, AttrList {
+            Attr {TSTR(UMeta::initializer), []()->int{ return { 8 }; }},
+        }},
+        Field {TSTR("mlsDegree"), &Type::mlsDegree, AttrList {
+            Attr {TSTR(UMeta::initializer), []()->int{ return { 2 }; }},
+        }},
         Field {TSTR("delta"), &Type::delta, AttrList {
             Attr {TSTR(UMeta::initializer), []()->float{ return { 1 }; }},
         }},
         Field {TSTR("sigma"), &Type::sigma, AttrList {
             Attr {TSTR(UMeta::initializer), []()->float{ return { 10.0 }; }},
         }},
+        Field {TSTR("fgtTolerance"), &Type::fgtTolerance, AttrList {
+            Attr {TSTR(UMeta::initializer), []()->float{ return { 1e-4 }; }},
+        }},
         Field {TSTR("lambda"), &Type::lambda, AttrList {
             Attr {TSTR(UMeta::initializer), []()->float{ return { 0.2 }; }},
         }},
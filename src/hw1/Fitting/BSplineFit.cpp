@@ -0,0 +1,210 @@
+#include "BSplineFit.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	// Diagonal and super diagonals of the Gram matrix, a cubic overlaps 3 neighbours.
+	constexpr int BAND = 4;
+	// Weight of the second difference penalty relative to the mean diagonal.
+	constexpr double SMOOTHING = 1e-9;
+	// A side of the knot range that has to grow moves past the samples by this
+	// fraction of their extent, so appending samples refills O(log n) times.
+	constexpr double HEADROOM = 0.25;
+	// Pivots below this fraction of their diagonal are rank deficiency.
+	constexpr double MIN_PIVOT = 1e-12;
+}
+
+void BSplineFitEngine::SetKnotCount(int count) {
+	count = std::max(count, 2);
+	if (count == knotCount) return;
+	knotCount = count;
+	filled = false;
+	MarkDirty();
+}
+
+int BSplineFitEngine::Basis(double x, double* b) const {
+	double s = (x - left) * invStep;
+	int span = std::clamp(static_cast<int>(std::floor(s)), 0, spans - 1);
+	double u = s - span;
+	double v = 1. - u;
+	double u2 = u * u;
+	double u3 = u2 * u;
+	b[0] = v * v * v / 6.;
+	b[1] = (3. * u3 - 6. * u2 + 4.) / 6.;
+	b[2] = (-3. * u3 + 3. * u2 + 3. * u + 1.) / 6.;
+	b[3] = u3 / 6.;
+	return span;
+}
+
+void BSplineFitEngine::Accumulate(double x, const double* y, double sign) {
+	int dim = Dim();
+	double b[4];
+	int first = Basis(x, b);
+	for (int a = 0; a < 4; ++a) {
+		double* row = &gram[(first + a) * BAND];
+		double weight = sign * b[a];
+		for (int r = 0; r < 4 - a; ++r) {
+			row[r] += weight * b[a + r];
+		}
+		for (int d = 0; d < dim; ++d) {
+			rhs[(first + a) * dim + d] += weight * y[d];
+		}
+	}
+}
+
+void BSplineFitEngine::Refill() {
+	int n = Size();
+	spans = knotCount - 1;
+	left = n > 0 ? *std::min_element(xs.begin(), xs.end()) : 0.;
+	right = n > 0 ? *std::max_element(xs.begin(), xs.end()) : 0.;
+	double pad = HEADROOM * (right - left);
+	if (growLeft) left -= pad;
+	if (growRight) right += pad;
+	growLeft = false;
+	growRight = false;
+	invStep = right > left ? spans / (right - left) : 1.;
+	int m = spans + 3;
+	gram.assign(m * BAND, 0.);
+	rhs.assign(m * Dim(), 0.);
+	for (int i = 0; i < n; ++i) {
+		Accumulate(xs[i], &ys[i * Dim()], 1.);
+	}
+	filled = true;
+}
+
+void BSplineFitEngine::OnPush() {
+	int i = Size() - 1;
+	double x = xs[i];
+	// Samples on the knot range keep the knots, others move them.
+	if (filled && x >= left && x <= right) {
+		Accumulate(x, &ys[i * Dim()], 1.);
+		return;
+	}
+	if (filled) {
+		growLeft = growLeft || x < left;
+		growRight = growRight || x > right;
+	}
+	filled = false;
+}
+
+void BSplineFitEngine::OnPop(double x, const double* y) {
+	// The knots still cover the remaining samples, Solve shrinks them once
+	// they cover far fewer.
+	if (filled) {
+		Accumulate(x, y, -1.);
+	}
+}
+
+void BSplineFitEngine::OnClear() {
+	filled = false;
+}
+
+void BSplineFitEngine::Solve(Eigen::MatrixXf& weights) {
+	int dim = Dim();
+	if (Size() == 0) {
+		controls.resize(0, dim);
+		weights.resize(0, dim);
+		return;
+	}
+	if (!filled) Refill();
+	int m = spans + 3;
+	// Controls without samples have an empty diagonal, refit the knots when
+	// pops left the samples on less than half of them.
+	double maxDiagonal = 0.;
+	for (int j = 0; j < m; ++j) {
+		maxDiagonal = std::max(maxDiagonal, gram[j * BAND]);
+	}
+	int first = 0;
+	int last = m - 1;
+	while (first < last && !(gram[first * BAND] > MIN_PIVOT * maxDiagonal)) ++first;
+	while (last > first && !(gram[last * BAND] > MIN_PIVOT * maxDiagonal)) --last;
+	if (right > left && 2 * (last - first + 1) < m) {
+		Refill();
+	}
+
+	// Penalty mu * D^T D, D the second differences of the controls, keeps the band.
+	std::vector<double> factor(gram);
+	double mean = 0.;
+	for (int j = 0; j < m; ++j) {
+		mean += factor[j * BAND];
+	}
+	double mu = SMOOTHING * mean / m;
+	for (int j = 0; j + 2 < m; ++j) {
+		const double c[3] = { 1., -2., 1. };
+		for (int a = 0; a < 3; ++a) {
+			for (int r = 0; r < 3 - a; ++r) {
+				factor[(j + a) * BAND + r] += mu * c[a] * c[a + r];
+			}
+		}
+	}
+
+	// Banded Cholesky, factor[j * BAND + r] becomes L(j + r, j).
+	controls.resize(m, dim);
+	for (int j = 0; j < m; ++j) {
+		double* col = &factor[j * BAND];
+		double diagonal = col[0];
+		for (int k = std::max(0, j - BAND + 1); k < j; ++k) {
+			const double* prev = &factor[k * BAND];
+			double ljk = prev[j - k];
+			// Rows j..k + BAND - 1 of column k meet column j.
+			for (int r = 0; r < BAND - (j - k); ++r) {
+				col[r] -= ljk * prev[j - k + r];
+			}
+		}
+		if (!(col[0] > MIN_PIVOT * diagonal)) {
+			// The penalty leaves lines free, so every sample shares one
+			// abscissa: fit their mean. The basis sums to 1, so the rhs entries
+			// of a column sum to its values.
+			for (int d = 0; d < dim; ++d) {
+				double sum = 0.;
+				for (int k = 0; k < m; ++k) {
+					sum += rhs[k * dim + d];
+				}
+				controls.col(d).setConstant(sum / Size());
+			}
+			weights = controls.cast<float>();
+			return;
+		}
+		col[0] = std::sqrt(col[0]);
+		for (int r = 1; r < BAND && j + r < m; ++r) {
+			col[r] /= col[0];
+		}
+	}
+
+	// L z = rhs, then L^T c = z, every value column on the same factor.
+	for (int d = 0; d < dim; ++d) {
+		for (int j = 0; j < m; ++j) {
+			double z = rhs[j * dim + d];
+			for (int k = std::max(0, j - BAND + 1); k < j; ++k) {
+				z -= factor[k * BAND + j - k] * controls(k, d);
+			}
+			controls(j, d) = z / factor[j * BAND];
+		}
+		for (int j = m - 1; j >= 0; --j) {
+			double c = controls(j, d);
+			for (int r = 1; r < BAND && j + r < m; ++r) {
+				c -= factor[j * BAND + r] * controls(j + r, d);
+			}
+			controls(j, d) = c / factor[j * BAND];
+		}
+	}
+	weights = controls.cast<float>();
+}
+
+void BSplineFitEngine::Eval(const float* xs, float* ys, int count, int column) {
+	Weights();
+	if (controls.rows() == 0) {
+		std::fill(ys, ys + count, 0.f);
+		return;
+	}
+	double b[4];
+	for (int i = 0; i < count; ++i) {
+		int first = Basis(xs[i], b);
+		double y = 0.;
+		for (int a = 0; a < 4; ++a) {
+			y += b[a] * controls(first + a, column);
+		}
+		ys[i] = static_cast<float>(y);
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "FittingEngine.h"
+
+// BS is BSplineFit abbreviation. Least-squares cubic B-spline with knotCount
+// uniform knots over the range of x, m = knotCount + 2 control values. A sample
+// touches the 4 basis functions of its span, so the Gram matrix B^T B has
+// bandwidth 4; it is accumulated in one pass over the samples and solved by a
+// banded Cholesky: O(n + m) time, O(m) memory, for any number of samples.
+// A point inside the knot range is pushed or popped in O(1) and the solve is
+// O(m). One outside moves the knots and accumulates every sample again, past
+// the new sample by a quarter of the extent so that appending at increasing x
+// stays O(1) amortized. Pops keep the knots until the samples cover less than
+// half of them.
+// Spans without samples would make the system singular, a tiny penalty on the
+// second differences of the control values bridges them with a straight line.
+// Samples sharing a single abscissa leave the line free, they fit their mean.
+// For a curve the samples are parameterized first, chordal or otherwise.
+class BSplineFitEngine : public IncrementalFit {
+public:
+	void SetKnotCount(int knotCount);
+	int ControlCount() const { return static_cast<int>(controls.rows()); }
+	void Eval(const float* xs, float* ys, int count, int column = 0);
+
+protected:
+	void OnPush() override;
+	void OnPop(double x, const double* y) override;
+	void OnClear() override;
+	// Weights() returns the control values, a column per value column.
+	void Solve(Eigen::MatrixXf& weights) override;
+
+private:
+	// First control and uniform basis weights of x, x outside the knots extends the end spans.
+	int Basis(double x, double* b) const;
+	void Accumulate(double x, const double* y, double sign);
+	// Knots over the cached samples and their Gram matrix from scratch.
+	void Refill();
+
+	int knotCount{ 8 };
+	int spans{ 1 };
+	double left{ 0 };
+	double right{ 0 };
+	double invStep{ 1 };
+	// gram and rhs hold every cached sample for the current knots.
+	bool filled{ false };
+	// Sides a push moved past, Refill adds headroom there.
+	bool growLeft{ false };
+	bool growRight{ false };
+	// gram[j * 4 + r] = G(j, j + r), rhs[j * Dim() + d] = sum b_j * y_d.
+	std::vector<double> gram;
+	std::vector<double> rhs;
+	// m x Dim()
+	Eigen::MatrixXd controls;
+};
@@ -0,0 +1,92 @@
+#include "Barycentric.h"
+
+#include <algorithm>
+#include <cmath>
+
+void BarycentricEngine::Eval(const float* xs, float* ys, int count, int column) const {
+	int n = Size();
+	for (int i = 0; i < count; ++i) {
+		double x = xs[i];
+		double numerator = 0;
+		double denominator = 0;
+		int exact = -1;
+		for (int j = 0; j < n; ++j) {
+			double diff = x - this->xs[j];
+			if (diff == 0) {
+				exact = j;
+				break;
+			}
+			double t = ws[j] / diff;
+			numerator += t * Y(j, column);
+			denominator += t;
+		}
+		ys[i] = static_cast<float>(exact != -1 ? Y(exact, column) : numerator / denominator);
+	}
+}
+
+void BarycentricEngine::OnPush() {
+	Append(Size() - 1);
+}
+
+void BarycentricEngine::Append(int n) {
+	double x = xs[n];
+	// w_n = 1 / prod(x - x_j) under- or overflows for a few hundred pixel-scale
+	// nodes, build it in log space with the same factor as the other weights.
+	double logW = logScale;
+	double sign = 1;
+	for (int j = 0; j < n; ++j) {
+		double diff = x - xs[j];
+		ws[j] /= -diff;
+		logW -= std::log(std::abs(diff));
+		if (diff < 0) sign = -sign;
+	}
+	ws.push_back(sign * std::exp(logW));
+	Normalize();
+}
+
+void BarycentricEngine::OnPop(double x, const double*) {
+	int n = Size();
+	ws.pop_back();
+	bool finite = true;
+	for (int j = 0; j < n; ++j) {
+		finite = finite && std::isfinite(ws[j]);
+	}
+	if (!finite) {
+		// A repeated node left infinite weights, dividing its factor back out
+		// gives NaN, so rebuild from the remaining nodes: O(n^2).
+		ws.clear();
+		logScale = 0;
+		for (int j = 0; j < n; ++j) {
+			Append(j);
+		}
+		return;
+	}
+	for (int j = 0; j < n; ++j) {
+		ws[j] *= xs[j] - x;
+	}
+	Normalize();
+}
+
+void BarycentricEngine::OnClear() {
+	ws.clear();
+	logScale = 0;
+}
+
+void BarycentricEngine::Solve(Eigen::MatrixXf& weights) {
+	weights.resize(Size(), 1);
+	for (int j = 0; j < Size(); ++j) {
+		weights(j) = static_cast<float>(ws[j]);
+	}
+}
+
+void BarycentricEngine::Normalize() {
+	double maxW = 0;
+	for (double w : ws) {
+		maxW = std::max(maxW, std::abs(w));
+	}
+	if (maxW == 0 || !std::isfinite(maxW)) return;
+	for (double& w : ws) {
+		w /= maxW;
+	}
+	logScale -= std::log(maxW);
+}
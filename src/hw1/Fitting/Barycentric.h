@@ -0,0 +1,32 @@
+#pragma once
+
+#include "FittingEngine.h"
+
+// Polynomial interpolation in the second (true) barycentric form
+//   p(x) = sum(w_j * y_j / (x - x_j)) / sum(w_j / (x - x_j)),
+// the same polynomial PIEngine expands into monomials, but stable for
+// hundreds of nodes. Push/pop rescale every weight once: O(n); an
+// evaluation is O(n) with no factorization at all. A repeated abscissa makes
+// the weights infinite until it is popped, the pop then rebuilds them: O(n^2).
+class BarycentricEngine : public IncrementalFit {
+public:
+	// Interpolate one value column at xs.
+	void Eval(const float* xs, float* ys, int count, int column = 0) const;
+
+protected:
+	void OnPush() override;
+	void OnPop(double x, const double*) override;
+	void OnClear() override;
+	// Weights() returns the barycentric weights, they do not depend on the values.
+	void Solve(Eigen::MatrixXf& weights) override;
+
+private:
+	// Weight of node n from the weights of nodes 0..n-1, which it rescales.
+	void Append(int n);
+	// The true form is invariant to a common factor, keep max |w| = 1.
+	void Normalize();
+
+	std::vector<double> ws;
+	// log of the common factor applied to ws by Normalize.
+	double logScale{ 0 };
+};
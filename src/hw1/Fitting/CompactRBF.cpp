@@ -0,0 +1,111 @@
+#include "CompactRBF.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+void CompactGIEngine::SetSigma(float s) {
+	if (s == sigma) return;
+	sigma = s;
+	support = SUPPORT_SCALE * sigma;
+	MarkDirty();
+}
+
+double CompactGIEngine::Kernel(double distance) const {
+	double r = distance / support;
+	if (r >= 1.) return 0.;
+	double t = 1. - r;
+	t *= t;
+	return t * t * (4. * r + 1.);
+}
+
+void CompactGIEngine::Solve(Eigen::MatrixXf& weights) {
+	int n = Size();
+	int dim = Dim();
+	std::vector<int> order(n);
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [this](int a, int b) { return xs[a] < xs[b]; });
+
+	// Merge samples sharing an abscissa, the system would be singular.
+	centers.clear();
+	std::vector<Eigen::RowVectorXd> values;
+	std::vector<int> counts;
+	for (int i : order) {
+		Eigen::RowVectorXd y(dim);
+		for (int d = 0; d < dim; ++d) {
+			y(d) = Y(i, d);
+		}
+		if (!centers.empty() && centers.back() == xs[i]) {
+			values.back() += y;
+			++counts.back();
+		}
+		else {
+			centers.push_back(xs[i]);
+			values.push_back(y);
+			counts.push_back(1);
+		}
+	}
+
+	int m = static_cast<int>(centers.size());
+	offsets.setZero(dim);
+	for (int i = 0; i < m; ++i) {
+		values[i] /= counts[i];
+		offsets += values[i];
+	}
+	if (m > 0) offsets /= m;
+
+	// Lower triangle of the banded kernel matrix.
+	std::vector<Eigen::Triplet<double>> triplets;
+	Eigen::MatrixXd b(m, dim);
+	for (int i = 0; i < m; ++i) {
+		for (int j = i; j < m && centers[j] - centers[i] < support; ++j) {
+			triplets.emplace_back(j, i, Kernel(centers[j] - centers[i]));
+		}
+		b.row(i) = values[i] - offsets;
+	}
+	Eigen::SparseMatrix<double> k(m, m);
+	k.setFromTriplets(triplets.begin(), triplets.end());
+
+	// Natural ordering keeps the band, there is no fill-in outside of it.
+	// One factorization serves every value column.
+	Eigen::SimplicialLLT<Eigen::SparseMatrix<double>, Eigen::Lower, Eigen::NaturalOrdering<int>> llt(k);
+	if (llt.info() == Eigen::Success) {
+		coeffs = llt.solve(b);
+	}
+	else {
+		// Nearly coincident centers, a small nugget restores definiteness.
+		Eigen::SparseMatrix<double> identity(m, m);
+		identity.setIdentity();
+		llt.compute(k + 1e-8 * identity);
+		coeffs = llt.solve(b);
+	}
+
+	weights.resize(m + 1, dim);
+	weights.row(0) = offsets.cast<float>();
+	weights.bottomRows(m) = coeffs.cast<float>();
+}
+
+void CompactGIEngine::Eval(const float* xs, float* ys, int count, int column) {
+	Weights();
+
+	int m = static_cast<int>(centers.size());
+	int first = 0;
+	double preX = -INFINITY;
+	for (int i = 0; i < count; ++i) {
+		double x = xs[i];
+		// First center inside the window, move forward for increasing x.
+		if (x >= preX) {
+			while (first < m && centers[first] <= x - support) ++first;
+		}
+		else {
+			first = static_cast<int>(std::upper_bound(centers.begin(), centers.end(), x - support) - centers.begin());
+		}
+		preX = x;
+
+		double y = offsets(column);
+		for (int j = first; j < m && centers[j] < x + support; ++j) {
+			y += coeffs(j, column) * Kernel(std::abs(x - centers[j]));
+		}
+		ys[i] = static_cast<float>(y);
+	}
+}
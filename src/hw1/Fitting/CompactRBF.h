@@ -0,0 +1,39 @@
+#pragma once
+
+#include "FittingEngine.h"
+#include "Eigen/Sparse"
+
+// GI with the compactly supported Wendland C2 kernel
+//   phi(r) = (1 - r)^4 * (4r + 1), r = |x - u| / (SUPPORT_SCALE * sigma) < 1,
+//   p(x) = mean(y) + sum w_j * phi(|x - u_j|).
+// With centers sorted the kernel matrix is banded and SPD, it is assembled
+// sparse and solved by a sparse Cholesky. Evaluation only visits the centers
+// inside the support window around x.
+class CompactGIEngine : public IncrementalFit {
+public:
+	// Support radius in units of sigma, phi(sigma) is close to the Gaussian's.
+	static constexpr double SUPPORT_SCALE = 3.;
+
+	void SetSigma(float sigma);
+	// Refits lazily, queries sorted by x only walk the window forward.
+	void Eval(const float* xs, float* ys, int count, int column = 0);
+
+protected:
+	void OnPush() override {}
+	void OnPop(double, const double*) override {}
+	void OnClear() override {}
+	// Weights() returns [mean, w_j...] in center order, a column per value column.
+	void Solve(Eigen::MatrixXf& weights) override;
+
+private:
+	double Kernel(double distance) const;
+
+	float sigma{ 1 };
+	double support{ 3 };
+	// Mean of every value column.
+	Eigen::RowVectorXd offsets;
+	// Sorted, duplicated abscissas merged.
+	std::vector<double> centers;
+	// centers x Dim()
+	Eigen::MatrixXd coeffs;
+};
@@ -0,0 +1,69 @@
+#include "CrossValidation.h"
+
+#include <algorithm>
+#include <cmath>
+#include "Eigen/Dense"
+#include "../../Common/TaskPool.h"
+
+std::vector<float> LogSpace(float lo, float hi, int count) {
+	std::vector<float> values(std::max(count, 0));
+	double logLo = std::log(lo);
+	double logHi = std::log(hi);
+	for (int i = 0; i < count; ++i) {
+		double t = count > 1 ? double(i) / (count - 1) : 0.;
+		values[i] = static_cast<float>(std::exp(logLo + (logHi - logLo) * t));
+	}
+	return values;
+}
+
+void GCVCurve::PickBest() {
+	best = -1;
+	for (int i = 0; i < static_cast<int>(scores.size()); ++i) {
+		if (std::isfinite(scores[i]) && (best == -1 || scores[i] < scores[best])) {
+			best = i;
+		}
+	}
+}
+
+GCVCurve SweepSigma(const float* xs, const float* const* columns, int dim, int count, const std::vector<float>& sigmas) {
+	GCVCurve curve;
+	curve.candidates = sigmas;
+	curve.scores.assign(sigmas.size(), INFINITY);
+	// Leaving one of two points out leaves nothing to fit.
+	if (count < 3) return curve;
+
+	Eigen::MatrixXd y(count, dim);
+	for (int d = 0; d < dim; ++d) {
+		for (int i = 0; i < count; ++i) {
+			y(i, d) = columns[d][i];
+		}
+		y.col(d).array() -= y.col(d).mean();
+	}
+
+	TaskPool::Instance().ParallelFor(static_cast<int>(sigmas.size()), [&](int s) {
+		double sigma = sigmas[s];
+		Eigen::MatrixXd k(count, count);
+		for (int j = 0; j < count; ++j) {
+			for (int i = 0; i < count; ++i) {
+				double v = (double(xs[i]) - xs[j]) / sigma;
+				k(i, j) = std::exp(-0.5 * v * v);
+			}
+		}
+		Eigen::LLT<Eigen::MatrixXd> llt(k);
+		if (llt.info() != Eigen::Success) {
+			// Nearly coincident samples, a small nugget restores definiteness.
+			k.diagonal().array() += 1e-10;
+			llt.compute(k);
+			if (llt.info() != Eigen::Success) return;
+		}
+		Eigen::MatrixXd c = llt.solve(y);
+		Eigen::VectorXd inverseDiagonal = llt.solve(Eigen::MatrixXd::Identity(count, count)).diagonal();
+		double sum = 0.;
+		for (int i = 0; i < count; ++i) {
+			sum += c.row(i).squaredNorm() / (inverseDiagonal(i) * inverseDiagonal(i));
+		}
+		curve.scores[s] = static_cast<float>(sum / (double(count) * dim));
+	});
+	curve.PickBest();
+	return curve;
+}
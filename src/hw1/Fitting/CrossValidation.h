@@ -0,0 +1,28 @@
+#pragma once
+
+// Automatic choice of the FR lambda and the GI sigma. LSEngine::SweepLambda
+// scores lambdas by generalized cross validation from one decomposition of
+// the Gram matrix, see FittingEngine.h. sigma changes the kernel matrix itself,
+// so SweepSigma factors it once per candidate and scores leave-one-out errors
+// in closed form (Rippa), candidates spread over the TaskPool.
+
+#include <vector>
+
+// Scores of a hyper parameter sweep, lower is better.
+struct GCVCurve {
+	std::vector<float> candidates;
+	std::vector<float> scores;
+	// Index of the lowest score, -1 when no candidate could be scored.
+	int best{ -1 };
+
+	float Best(float fallback) const { return best == -1 ? fallback : candidates[best]; }
+	// Set best from scores, non-finite scores are skipped.
+	void PickBest();
+};
+
+// count values from lo to hi, evenly spaced in log scale.
+std::vector<float> LogSpace(float lo, float hi, int count);
+
+// Mean squared leave-one-out error of Gaussian interpolation over xs for every
+// sigma, e_i = c_i / (K^-1)_ii with K c = y - mean(y). columns[d] share xs.
+GCVCurve SweepSigma(const float* xs, const float* const* columns, int dim, int count, const std::vector<float>& sigmas);
@@ -0,0 +1,67 @@
+#include "FastGauss.h"
+
+#include <algorithm>
+#include <cmath>
+
+void FastGaussTransform::Build(const float* us, int n, const float* weights, float sigma, float tolerance) {
+	double eps = std::min(std::max(static_cast<double>(tolerance), 1e-12), 0.5);
+
+	h = std::sqrt(2.) * sigma;
+	boxWidth = h;
+	offset = weights[0];
+
+	// With x = (t - c) / h, u = (u_j - c) / h and |u| <= r:
+	//   exp(-(x - u)^2) = exp(-x^2) * exp(-u^2) * sum (2xu)^k / k!,
+	// dropping k >= order costs at most (2 |x| r)^order / order! per unit weight.
+	// A box beyond cutoff costs at most exp(-(cutoff - r)^2) <= eps.
+	double r = 0.5 * boxWidth / h;
+	cutoff = r + std::sqrt(std::log(1. / eps));
+	order = 1;
+	double bound = 2. * r * cutoff;
+	while (order < MAX_ORDER && bound > eps) {
+		++order;
+		bound *= 2. * r * cutoff / order;
+	}
+
+	left = n > 0 ? *std::min_element(us, us + n) : 0.;
+	double right = n > 0 ? *std::max_element(us, us + n) : 0.;
+	boxCount = static_cast<int>(std::floor((right - left) / boxWidth)) + 1;
+	coeffs.assign(static_cast<size_t>(boxCount) * order, 0.);
+	used.assign(boxCount, false);
+
+	for (int j = 0; j < n; ++j) {
+		int box = std::min(static_cast<int>((us[j] - left) / boxWidth), boxCount - 1);
+		double u = (us[j] - (left + (box + 0.5) * boxWidth)) / h;
+		// t_k = w * exp(-u^2) * (2u)^k / k!
+		double t = weights[j + 1] * std::exp(-u * u);
+		double* c = &coeffs[static_cast<size_t>(box) * order];
+		for (int k = 0; k < order; ++k) {
+			c[k] += t;
+			t *= 2. * u / (k + 1);
+		}
+		used[box] = true;
+	}
+}
+
+void FastGaussTransform::Eval(const float* xs, float* ys, int count) const {
+	double reach = cutoff * h;
+	for (int i = 0; i < count; ++i) {
+		double t = xs[i];
+		int first = std::max(static_cast<int>(std::floor((t - reach - left) / boxWidth)), 0);
+		int last = std::min(static_cast<int>(std::floor((t + reach - left) / boxWidth)), boxCount - 1);
+
+		double y = offset;
+		for (int box = first; box <= last; ++box) {
+			if (!used[box]) continue;
+			double x = (t - (left + (box + 0.5) * boxWidth)) / h;
+			if (std::abs(x) > cutoff) continue;
+			const double* c = &coeffs[static_cast<size_t>(box) * order];
+			double s = c[order - 1];
+			for (int k = order - 2; k >= 0; --k) {
+				s = s * x + c[k];
+			}
+			y += std::exp(-x * x) * s;
+		}
+		ys[i] = static_cast<float>(y);
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+
+// Improved fast Gauss transform, evaluates the GI expansion
+//   f(x) = w_0 + sum w_j * exp(-0.5 * ((x - u_j) / sigma)^2)
+// in O((centers + targets) * order) instead of O(centers * targets).
+// Centers are grouped into boxes of width h = sqrt(2) * sigma. Each box keeps a
+// truncated Taylor expansion of its Gaussians about its center, a target only
+// sums the boxes within the cutoff radius. Both truncations are chosen so the
+// absolute error stays below tolerance * sum |w_j|.
+class FastGaussTransform {
+public:
+	static constexpr int MAX_ORDER = 40;
+
+	// weights has GaussSolver's layout: [w_0, w_1, ..., w_n], n = count.
+	void Build(const float* us, int count, const float* weights, float sigma, float tolerance);
+	void Eval(const float* xs, float* ys, int count) const;
+	int Order() const { return order; }
+
+private:
+	double h{ 1 };
+	double left{ 0 };
+	double boxWidth{ 1 };
+	// Boxes farther than cutoff (in units of h) from a target are ignored.
+	double cutoff{ 0 };
+	double offset{ 0 };
+	int order{ 0 };
+	int boxCount{ 0 };
+	// boxCount * order Taylor coefficients, box by box.
+	std::vector<double> coeffs;
+	std::vector<bool> used;
+};
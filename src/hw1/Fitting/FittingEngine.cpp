@@ -0,0 +1,408 @@
+#include "FittingEngine.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+void IncrementalFit::Sync(const float* newXs, const float* const* columns, int newDim, int n) {
+	if (newDim != dim) {
+		xs.clear();
+		ys.clear();
+		OnClear();
+		dim = newDim;
+		dirty = true;
+	}
+
+	int keep = 0;
+	int cachedCount = Size();
+	for (; keep < n && keep < cachedCount && xs[keep] == newXs[keep]; ++keep) {
+		int d = 0;
+		while (d < dim && Y(keep, d) == columns[d][keep]) ++d;
+		if (d < dim) break;
+	}
+
+	std::vector<double> y(dim);
+	while (Size() > keep) {
+		double x = xs.back();
+		xs.pop_back();
+		for (int d = dim - 1; d >= 0; --d) {
+			y[d] = ys.back();
+			ys.pop_back();
+		}
+		OnPop(x, y.data());
+		dirty = true;
+	}
+	for (int i = keep; i < n; ++i) {
+		xs.push_back(newXs[i]);
+		for (int d = 0; d < dim; ++d) {
+			ys.push_back(columns[d][i]);
+		}
+		OnPush();
+		dirty = true;
+	}
+}
+
+const Eigen::MatrixXf& IncrementalFit::Weights() {
+	if (dirty) {
+		Solve(weights);
+		dirty = false;
+	}
+	return weights;
+}
+
+void IncrementalFit::Rebuild() {
+	std::vector<double> cachedXs;
+	std::vector<double> cachedYs;
+	cachedXs.swap(xs);
+	cachedYs.swap(ys);
+	OnClear();
+	int count = static_cast<int>(cachedXs.size());
+	for (int i = 0; i < count; ++i) {
+		xs.push_back(cachedXs[i]);
+		ys.insert(ys.end(), cachedYs.begin() + i * dim, cachedYs.begin() + (i + 1) * dim);
+		OnPush();
+	}
+	dirty = true;
+}
+
+void PIEngine::OnPush() {
+	int i = Size() - 1;
+	int dim = Dim();
+	std::vector<double> row((i + 1) * dim);
+	for (int d = 0; d < dim; ++d) {
+		row[d] = Y(i, d);
+	}
+	for (int j = 1; j <= i; ++j) {
+		// Every column shares the abscissas, so the divisor.
+		double inv = 1. / (xs[i] - xs[i - j]);
+		for (int d = 0; d < dim; ++d) {
+			row[j * dim + d] = (row[(j - 1) * dim + d] - table[i - 1][(j - 1) * dim + d]) * inv;
+		}
+	}
+	table.push_back(std::move(row));
+}
+
+void PIEngine::OnPop(double, const double*) {
+	table.pop_back();
+}
+
+void PIEngine::OnClear() {
+	table.clear();
+}
+
+void PIEngine::Solve(Eigen::MatrixXf& weights) {
+	int n = Size();
+	int dim = Dim();
+	weights.setZero(n, dim);
+	if (n == 0) return;
+
+	// Expand the Newton form into monomials, the Vandermonde solution.
+	std::vector<double> c(n);
+	for (int d = 0; d < dim; ++d) {
+		std::fill(c.begin(), c.end(), 0.);
+		c[0] = table[n - 1][(n - 1) * dim + d];
+		for (int j = n - 2; j >= 0; --j) {
+			for (int m = n - 1 - j; m >= 1; --m) {
+				c[m] = c[m - 1] - xs[j] * c[m];
+			}
+			c[0] = table[j][j * dim + d] - xs[j] * c[0];
+		}
+		for (int i = 0; i < n; ++i) {
+			weights(i, d) = static_cast<float>(c[i]);
+		}
+	}
+}
+
+void GIEngine::SetSigma(float s) {
+	if (s == sigma) return;
+	sigma = s;
+	Rebuild();
+}
+
+double GIEngine::Kernel(double x, double u) const {
+	double v = (x - u) / sigma;
+	return std::exp(-0.5 * v * v);
+}
+
+void GIEngine::OnPush() {
+	int i = Size() - 1;
+	size_t begin = factor.size();
+	factor.resize(begin + i + 1);
+	double* row = &factor[begin];
+
+	// Solve L * row = k, then the pivot is sqrt(K(x, x) - row * row).
+	double diag = 1.;
+	for (int j = 0; j < i; ++j) {
+		const double* rowJ = &factor[j * (j + 1) / 2];
+		double s = Kernel(xs[i], xs[j]);
+		for (int p = 0; p < j; ++p) {
+			s -= row[p] * rowJ[p];
+		}
+		row[j] = rowJ[j] > 0. ? s / rowJ[j] : 0.;
+		diag -= row[j] * row[j];
+	}
+
+	if (diag <= 1e-12) {
+		row[i] = 0.;
+		if (badPivot == -1) badPivot = i;
+	}
+	else {
+		row[i] = std::sqrt(diag);
+	}
+}
+
+void GIEngine::OnPop(double, const double*) {
+	int n = Size();
+	factor.resize(n * (n + 1) / 2);
+	if (badPivot >= n) badPivot = -1;
+}
+
+void GIEngine::OnClear() {
+	factor.clear();
+	badPivot = -1;
+}
+
+void GIEngine::SolveFactor(Eigen::MatrixXd& v) const {
+	int n = Size();
+	for (int c = 0; c < v.cols(); ++c) {
+		double* col = v.col(c).data();
+		for (int i = 0; i < n; ++i) {
+			const double* row = &factor[i * (i + 1) / 2];
+			double s = col[i];
+			for (int j = 0; j < i; ++j) {
+				s -= row[j] * col[j];
+			}
+			col[i] = s / row[i];
+		}
+		for (int i = n - 1; i >= 0; --i) {
+			double s = col[i];
+			for (int j = i + 1; j < n; ++j) {
+				s -= factor[j * (j + 1) / 2 + i] * col[j];
+			}
+			col[i] = s / factor[i * (i + 1) / 2 + i];
+		}
+	}
+}
+
+void GIEngine::Solve(Eigen::MatrixXf& weights) {
+	int n = Size();
+	int dim = Dim();
+	assert(n >= 2);
+	if (badPivot != -1) {
+		SolveDense(weights);
+		return;
+	}
+
+	// K * w + w0 = y, kc * w + w0 = yc with kc the kernel row of the end constraint.
+	// w = alpha - w0 * beta, alpha = K^-1 * y, beta = K^-1 * 1.
+	// beta is shared, alpha has one column per value column.
+	Eigen::MatrixXd alpha(n, dim);
+	Eigen::MatrixXd beta = Eigen::MatrixXd::Ones(n, 1);
+	for (int i = 0; i < n; ++i) {
+		for (int d = 0; d < dim; ++d) {
+			alpha(i, d) = Y(i, d);
+		}
+	}
+	SolveFactor(alpha);
+	SolveFactor(beta);
+
+	double centerX = (xs[n - 2] + xs[n - 1]) * 0.5;
+	Eigen::RowVectorXd kcAlpha = Eigen::RowVectorXd::Zero(dim);
+	double kcBeta = 0;
+	for (int j = 0; j < n; ++j) {
+		double kc = Kernel(centerX, xs[j]);
+		kcAlpha += kc * alpha.row(j);
+		kcBeta += kc * beta(j);
+	}
+
+	double denominator = 1. - kcBeta;
+	if (std::abs(denominator) < 1e-12) {
+		SolveDense(weights);
+		return;
+	}
+
+	weights.resize(n + 1, dim);
+	for (int d = 0; d < dim; ++d) {
+		double centerY = (Y(n - 2, d) + Y(n - 1, d)) * 0.5;
+		double w0 = (centerY - kcAlpha(d)) / denominator;
+		weights(0, d) = static_cast<float>(w0);
+		for (int j = 0; j < n; ++j) {
+			weights(j + 1, d) = static_cast<float>(alpha(j, d) - w0 * beta(j));
+		}
+	}
+}
+
+void GIEngine::SolveDense(Eigen::MatrixXf& weights) const {
+	int n = Size();
+	int dim = Dim();
+	Eigen::MatrixXd m(n + 1, n + 1);
+	Eigen::MatrixXd y(n + 1, dim);
+
+	for (int i = 0; i < n; ++i) {
+		m(i, 0) = 1;
+		for (int j = 0; j < n; ++j) {
+			m(i, j + 1) = Kernel(xs[i], xs[j]);
+		}
+		for (int d = 0; d < dim; ++d) {
+			y(i, d) = Y(i, d);
+		}
+	}
+
+	// Add constraint(end two points center)
+	double centerX = (xs[n - 2] + xs[n - 1]) * 0.5;
+	m(n, 0) = 1;
+	for (int j = 0; j < n; ++j) {
+		m(n, j + 1) = Kernel(centerX, xs[j]);
+	}
+	for (int d = 0; d < dim; ++d) {
+		y(n, d) = (Y(n - 2, d) + Y(n - 1, d)) * 0.5;
+	}
+
+	weights = m.colPivHouseholderQr().solve(y).cast<float>();
+}
+
+void LSEngine::SetFitBaseCount(int count) {
+	if (count == fitBaseCount) return;
+	fitBaseCount = count;
+	Refill();
+	MarkDirty();
+}
+
+void LSEngine::SetLambda(float l) {
+	if (l == lambda) return;
+	lambda = l;
+	MarkDirty();
+}
+
+void LSEngine::SetBasis(FitBasis b) {
+	if (b == basis) return;
+	basis = b;
+	Refill();
+	MarkDirty();
+}
+
+int LSEngine::BaseCount(int n) const {
+	// Fall back to interpolation when there are too few points.
+	return (2 <= fitBaseCount && fitBaseCount <= n) ? fitBaseCount : n;
+}
+
+void LSEngine::OnPush() {
+	int n = Size();
+	double x = xs.back();
+	if (BaseCount(n) != k || std::abs(x - center) > 2. * scale) {
+		Refill();
+		return;
+	}
+	GetLSKernel(k, basis).accumulate(k, &xs[n - 1], &ys[(n - 1) * Dim()], Dim(), 1, center, scale, 1., sums.data(), moments.data());
+}
+
+void LSEngine::OnPop(double x, const double* y) {
+	if (BaseCount(Size()) != k) {
+		Refill();
+		return;
+	}
+	// Nothing is factorized, so a downdate cannot fail, but it does cancel and
+	// the monomial Gram matrix is ill conditioned at large k, see LSKernels.h.
+	GetLSKernel(k, basis).accumulate(k, &x, y, Dim(), 1, center, scale, -1., sums.data(), moments.data());
+}
+
+void LSEngine::OnClear() {
+	k = 0;
+	sums.resize(0);
+	moments.resize(0, 0);
+}
+
+void LSEngine::Refill() {
+	int n = Size();
+	k = BaseCount(n);
+	center = 0.;
+	scale = 1.;
+	if (basis == Chebyshev && n > 0) {
+		// Map [min, max] onto [-1, 1].
+		auto range = std::minmax_element(xs.begin(), xs.end());
+		center = (*range.first + *range.second) * 0.5;
+		scale = std::max(scale, (*range.second - *range.first) * 0.5);
+	}
+	else {
+		for (int i = 0; i < n; ++i) {
+			scale = std::max(scale, std::abs(xs[i]));
+		}
+	}
+
+	sums.setZero(std::max(2 * k - 1, 0));
+	moments.setZero(k, Dim());
+	if (k == 0) return;
+	GetLSKernel(k, basis).accumulate(k, xs.data(), ys.data(), Dim(), n, center, scale, 1., sums.data(), moments.data());
+}
+
+void LSEngine::Solve(Eigen::MatrixXf& weights) {
+	weights.setZero(k, Dim());
+	if (k == 0) return;
+	GetLSKernel(k, basis).solve(k, sums.data(), moments.data(), Dim(), lambda, scale, weights.data());
+}
+
+GCVCurve LSEngine::SweepLambda(const std::vector<float>& lambdas) const {
+	GCVCurve curve;
+	curve.candidates = lambdas;
+	curve.scores.assign(lambdas.size(), INFINITY);
+	int n = Size();
+	int dim = Dim();
+	if (k == 0 || n <= k) return curve;
+
+	// Gram matrix and penalty in the accumulated basis, as GetLSKernel solves them.
+	Eigen::MatrixXd g(k, k);
+	Eigen::MatrixXd p(k, k);
+	if (basis == Monomial) {
+		Eigen::VectorXd powers(k);
+		double s = 1.;
+		for (int j = 0; j < k; ++j) {
+			powers(j) = s;
+			s /= scale;
+		}
+		for (int j = 0; j < k; ++j) {
+			for (int i = 0; i < k; ++i) {
+				g(i, j) = sums[i + j];
+			}
+		}
+		p = powers * powers.transpose();
+	}
+	else {
+		for (int j = 0; j < k; ++j) {
+			for (int i = 0; i < k; ++i) {
+				g(i, j) = 0.5 * (sums[i + j] + sums[std::abs(i - j)]);
+			}
+		}
+		p.setIdentity();
+	}
+	Eigen::LLT<Eigen::MatrixXd> llt(g);
+	if (llt.info() != Eigen::Success) return curve;
+
+	// M = L^-1 P L^-T, z = V^T L^-1 B; |z|^2 is the part of |y|^2 the basis reaches.
+	Eigen::MatrixXd half = llt.matrixL().solve(p);
+	Eigen::MatrixXd m = llt.matrixL().solve(half.transpose());
+	Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigen(m);
+	const Eigen::VectorXd& mu = eigen.eigenvalues();
+	Eigen::MatrixXd z = eigen.eigenvectors().transpose() * llt.matrixL().solve(moments);
+	Eigen::VectorXd zz = z.rowwise().squaredNorm();
+	double yy = 0.;
+	for (double y : ys) {
+		yy += y * y;
+	}
+	double outside = std::max(yy - zz.sum(), 0.);
+
+	for (int c = 0; c < static_cast<int>(lambdas.size()); ++c) {
+		double lambda = lambdas[c];
+		double trace = 0.;
+		double rss = outside;
+		for (int i = 0; i < k; ++i) {
+			double shrink = lambda * std::max(mu(i), 0.);
+			double f = 1. / (1. + shrink);
+			trace += f;
+			rss += (shrink * f) * (shrink * f) * zz(i);
+		}
+		double dof = 1. - trace / n;
+		curve.scores[c] = static_cast<float>(rss / (double(n) * dim) / (dof * dof));
+	}
+	curve.PickBest();
+	return curve;
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cassert>
+#include <vector>
+#include "Eigen/Dense"
+#include "CrossValidation.h"
+#include "LSKernels.h"
+
+// Keep the factorization of one fitting method alive between frames.
+// Sync() diffs the samples against the cached ones: the common prefix is kept,
+// dropped points are popped and new points are pushed. Adding a point or
+// RemoveOne therefore costs one update instead of rebuilding the whole system.
+// Samples may carry several values (x and y of a curve over t), they share the
+// factorization and are solved as multiple right-hand sides.
+class IncrementalFit {
+public:
+	virtual ~IncrementalFit() = default;
+
+	// columns[d][i] is value d of sample i, every column shares xs.
+	void Sync(const float* xs, const float* const* columns, int dim, int count);
+	void Sync(const float* xs, const float* ys, int count) { Sync(xs, &ys, 1, count); }
+	void Sync(const std::vector<float>& xs, const std::vector<float>& ys) {
+		assert(xs.size() == ys.size());
+		Sync(xs.data(), ys.data(), static_cast<int>(xs.size()));
+	}
+	// One column per value column, same layout as PolynomialSolver/GaussSolver expect.
+	const Eigen::MatrixXf& Weights();
+	int Size() const { return static_cast<int>(xs.size()); }
+	int Dim() const { return dim; }
+
+protected:
+	// Called after the point has been appended to xs/ys.
+	virtual void OnPush() = 0;
+	// Called after the last point has been removed from xs/ys, y has Dim() values.
+	virtual void OnPop(double x, const double* y) = 0;
+	virtual void OnClear() = 0;
+	virtual void Solve(Eigen::MatrixXf& weights) = 0;
+
+	// Refactor from scratch, used when a hyper parameter changes.
+	void Rebuild();
+	void MarkDirty() { dirty = true; }
+	// Value d of sample i.
+	double Y(int i, int d) const { return ys[i * dim + d]; }
+
+	std::vector<double> xs;
+	// Dim() values per sample.
+	std::vector<double> ys;
+
+private:
+	Eigen::MatrixXf weights;
+	int dim{ 1 };
+	bool dirty{ true };
+};
+
+// PI is PolynomialInterpolate abbreviation.
+// Newton divided differences are the LU factorization of the Vandermonde
+// matrix, appending a point adds one row: O(n) push, O(1) pop, O(n^2) solve.
+class PIEngine : public IncrementalFit {
+protected:
+	void OnPush() override;
+	void OnPop(double x, const double* y) override;
+	void OnClear() override;
+	void Solve(Eigen::MatrixXf& weights) override;
+
+private:
+	// table[i][j * Dim() + d] = f[x_i-j, ..., x_i] of column d, the Newton
+	// coefficients are table[i][i * Dim() + d].
+	std::vector<std::vector<double>> table;
+};
+
+// GI is GaussInterpolate abbreviation. Centers are the samples themselves.
+// The kernel matrix is SPD, its Cholesky factor grows by bordering: O(n^2) push,
+// O(1) pop. The constant term and the end constraint are eliminated by a Schur
+// complement, so a solve is two triangular solves instead of an inverse.
+class GIEngine : public IncrementalFit {
+public:
+	void SetSigma(float sigma);
+
+protected:
+	void OnPush() override;
+	void OnPop(double x, const double* y) override;
+	void OnClear() override;
+	void Solve(Eigen::MatrixXf& weights) override;
+
+private:
+	double Kernel(double x, double u) const;
+	// v = K^-1 v, column by column
+	void SolveFactor(Eigen::MatrixXd& v) const;
+	// Dense solve of the bordered system, used when the factor lost positive definiteness.
+	void SolveDense(Eigen::MatrixXf& weights) const;
+
+	float sigma{ 1 };
+	// Lower triangular factor packed by rows.
+	std::vector<double> factor;
+	// First row whose pivot is not positive (duplicated samples).
+	int badPivot{ -1 };
+};
+
+// PF is PolynomialFit abbreviation, FR is FittingRidge abbreviation.
+// Accumulate the power sums of the Hankel Gram matrix and the moments, a point
+// costs O(k) (push or pop), k = fitBaseCount. A solve is a k x k Cholesky with
+// a kernel specialized for k, see LSKernels.h.
+class LSEngine : public IncrementalFit {
+public:
+	void SetFitBaseCount(int fitBaseCount);
+	// FR adds lambda to every entry of the Gram matrix, lambda = 0 is PF.
+	// In the Chebyshev basis FR is the plain ridge lambda * I instead.
+	void SetLambda(float lambda);
+	// Monomial weights are for EvalPolynomial, Chebyshev weights for
+	// EvalChebyshev with Center() and Scale().
+	void SetBasis(FitBasis basis);
+	FitBasis Basis() const { return basis; }
+	float Center() const { return static_cast<float>(center); }
+	float Scale() const { return static_cast<float>(scale); }
+	// GCV score n * RSS / (n - trace(H))^2 of every lambda. With G = L L^T and
+	// L^-1 P L^-T = V diag(mu) V^T, P the FR penalty, one decomposition gives
+	// trace(H) = sum 1 / (1 + lambda * mu_i) and the residual in closed form:
+	// O(k^3) once, O(k * Dim()) per candidate. Needs more samples than k.
+	GCVCurve SweepLambda(const std::vector<float>& lambdas) const;
+
+protected:
+	void OnPush() override;
+	void OnPop(double x, const double* y) override;
+	void OnClear() override;
+	void Solve(Eigen::MatrixXf& weights) override;
+
+private:
+	int BaseCount(int n) const;
+	// Accumulate every cached sample again, used when k or scale changes.
+	void Refill();
+
+	int fitBaseCount{ 4 };
+	float lambda{ 0 };
+	FitBasis basis{ Monomial };
+	int k{ 0 };
+	// Columns are b_j((x - center) / scale), which keeps the Gram matrix
+	// representable. center is 0 for the monomial basis.
+	double center{ 0 };
+	double scale{ 1 };
+	// 2k - 1 power sums
+	Eigen::VectorXd sums;
+	// k x Dim(), one right-hand side per value column.
+	Eigen::MatrixXd moments;
+};
@@ -0,0 +1,22 @@
+#include "FittingKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+void SampleRange(float left, float right, float delta, float* xs, int count) {
+	for (int i = 0; i < count; ++i) {
+		xs[i] = std::min(left + i * delta, right);
+	}
+}
+
+void EvalGauss(const float* us, int centerCount, float sigma, const float* coeffs, const float* xs, float* ys, int count) {
+	float invSigma = 1.f / sigma;
+	for (int i = 0; i < count; ++i) {
+		float y = coeffs[0];
+		for (int j = 0; j < centerCount; ++j) {
+			float v = (xs[i] - us[j]) * invSigma;
+			y += coeffs[j + 1] * std::exp(-0.5f * v * v);
+		}
+		ys[i] = y;
+	}
+}
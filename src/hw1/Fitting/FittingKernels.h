@@ -0,0 +1,14 @@
+#pragma once
+
+// Plain float array entry points of the hw1 fitting math, no ImGui or Utopia
+// types, so they also build in bench/. Engines live in FittingEngine.h.
+// ParamMode and Parameterize are shared with hw4, see Common/Parameterization.h.
+
+#include "../../Common/Parameterization.h"
+
+// xs[i] = min(left + i * delta, right), i in [0, count)
+void SampleRange(float left, float right, float delta, float* xs, int count);
+
+// Direct GI evaluation, coeffs has GaussSolver's layout [w_0, w_1, ..., w_n]:
+// ys[i] = w_0 + sum w_j+1 * exp(-0.5 * ((xs[i] - us[j]) / sigma)^2)
+void EvalGauss(const float* us, int centerCount, float sigma, const float* coeffs, const float* xs, float* ys, int count);
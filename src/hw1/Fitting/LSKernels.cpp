@@ -0,0 +1,139 @@
+#include "LSKernels.h"
+
+#include <cassert>
+#include <cstdlib>
+#include "Eigen/Dense"
+
+namespace {
+	// Successive basis functions b_0(u), b_1(u), ... scaled by a factor.
+	template<FitBasis Basis>
+	struct BasisIterator;
+
+	template<>
+	struct BasisIterator<Monomial> {
+		double u, p;
+		BasisIterator(double u, double factor) : u(u), p(factor) {}
+		double Next() {
+			double b = p;
+			p *= u;
+			return b;
+		}
+	};
+
+	// T_0 = 1, T_1 = u, T_m+1 = 2u * T_m - T_m-1
+	template<>
+	struct BasisIterator<Chebyshev> {
+		double u, prev, cur;
+		BasisIterator(double u, double factor) : u(u), prev(factor * u), cur(factor) {}
+		double Next() {
+			double b = cur;
+			double next = 2. * u * cur - prev;
+			prev = cur;
+			cur = next;
+			return b;
+		}
+	};
+
+	// Duplicated abscissas make the normal equations singular, take the minimum
+	// norm solution. This is rare, so every k shares one runtime-sized
+	// decomposition: a fixed-size one per k would dominate the build.
+	void SolveSingular(const Eigen::MatrixXd& a, const double* moments, int dim, const double* powers, float* weights) {
+		int k = static_cast<int>(a.rows());
+		Eigen::MatrixXd w = a.completeOrthogonalDecomposition().solve(Eigen::Map<const Eigen::MatrixXd>(moments, k, dim));
+		for (int d = 0; d < dim; ++d) {
+			for (int j = 0; j < k; ++j) {
+				weights[d * k + j] = static_cast<float>(w(j, d) * powers[j]);
+			}
+		}
+	}
+
+	// K = Eigen::Dynamic uses the runtime k, otherwise every loop has a fixed trip count.
+	template<int K, FitBasis Basis>
+	void Accumulate(int k, const double* xs, const double* ys, int dim, int count, double center, double scale, double sign, double* sums, double* moments) {
+		assert(K == Eigen::Dynamic || k == K);
+		const int n = K == Eigen::Dynamic ? k : K;
+		double invScale = 1. / scale;
+		for (int i = 0; i < count; ++i) {
+			double u = (xs[i] - center) * invScale;
+			BasisIterator<Basis> b(u, sign);
+			for (int m = 0; m < 2 * n - 1; ++m) {
+				sums[m] += b.Next();
+			}
+			for (int d = 0; d < dim; ++d) {
+				double* moment = moments + d * n;
+				BasisIterator<Basis> by(u, sign * ys[i * dim + d]);
+				for (int j = 0; j < n; ++j) {
+					moment[j] += by.Next();
+				}
+			}
+		}
+	}
+
+	template<int K, FitBasis Basis>
+	void Solve(int k, const double* sums, const double* moments, int dim, double lambda, double scale, float* weights) {
+		assert(K == Eigen::Dynamic || k == K);
+		const int n = K == Eigen::Dynamic ? k : K;
+		using Matrix = Eigen::Matrix<double, K, K>;
+		using Vector = Eigen::Matrix<double, K, 1>;
+
+		// resize() is a no-op for fixed sizes, it only sizes the Dynamic kernel.
+		Vector powers;
+		powers.resize(n);
+		Matrix a;
+		a.resize(n, n);
+		if (Basis == Monomial) {
+			double s = 1.;
+			for (int j = 0; j < n; ++j) {
+				powers(j) = s;
+				s /= scale;
+			}
+			// In the scaled basis lambda * ones * ones^T becomes lambda * d * d^T, d_j = scale^-j.
+			for (int j = 0; j < n; ++j) {
+				for (int i = 0; i < n; ++i) {
+					a(i, j) = sums[i + j] + lambda * powers(i) * powers(j);
+				}
+			}
+		}
+		else {
+			// The coefficients are the weights themselves, there is nothing to unscale.
+			powers.setOnes();
+			for (int j = 0; j < n; ++j) {
+				for (int i = 0; i < n; ++i) {
+					a(i, j) = 0.5 * (sums[i + j] + sums[std::abs(i - j)]);
+				}
+				a(j, j) += lambda;
+			}
+		}
+
+		Eigen::LLT<Matrix> llt(a);
+		if (llt.info() != Eigen::Success) {
+			SolveSingular(a, moments, dim, powers.data(), weights);
+			return;
+		}
+		for (int d = 0; d < dim; ++d) {
+			Vector w = llt.solve(Eigen::Map<const Vector>(moments + d * n, n));
+			for (int j = 0; j < n; ++j) {
+				weights[d * n + j] = static_cast<float>(w(j) * powers(j));
+			}
+		}
+	}
+
+	template<int K, FitBasis Basis>
+	constexpr LSKernel MakeKernel() {
+		return { &Accumulate<K, Basis>, &Solve<K, Basis> };
+	}
+
+	template<FitBasis Basis>
+	struct KernelTable {
+		static constexpr LSKernel kernels[MAX_FIXED_BASE_COUNT + 1] = {
+			MakeKernel<Eigen::Dynamic, Basis>(),
+			MakeKernel<1, Basis>(), MakeKernel<2, Basis>(), MakeKernel<3, Basis>(), MakeKernel<4, Basis>(), MakeKernel<5, Basis>(),
+			MakeKernel<6, Basis>(), MakeKernel<7, Basis>(), MakeKernel<8, Basis>(), MakeKernel<9, Basis>(), MakeKernel<10, Basis>(),
+		};
+	};
+}
+
+const LSKernel& GetLSKernel(int k, FitBasis basis) {
+	const LSKernel* kernels = basis == Chebyshev ? KernelTable<Chebyshev>::kernels : KernelTable<Monomial>::kernels;
+	return (1 <= k && k <= MAX_FIXED_BASE_COUNT) ? kernels[k] : kernels[0];
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+// Least-squares kernels shared by LSEngine and StreamingLSFit, specialized at
+// compile time for every k = fitBaseCount up to MAX_FIXED_BASE_COUNT and picked
+// from a table at runtime. Larger k falls back to a runtime-sized kernel.
+// Columns are (x / scale)^j, so the Gram matrix is Hankel: G(i, j) = s[i + j]
+// with power sums s[m] = sum (x / scale)^m. A sample costs O(k) instead of
+// O(k^2), and fixed sizes keep the solve on the stack without allocation.
+// A Hankel Gram matrix of powers is ill conditioned, its condition number
+// grows exponentially with k. Near k = 10 the solve, and cancellation in sums
+// downdated by pops, lose several digits.
+// The Chebyshev kernels map x to u = (x - center) / scale in [-1, 1] and use
+// T_i * T_j = (T_i+j + T_|i-j|) / 2, so their Gram matrix also only needs the
+// 2k - 1 sums s[m] = sum T_m(u). It stays well conditioned for every k.
+
+// Upper bound of the fitBaseCount slider.
+constexpr int MAX_FIXED_BASE_COUNT = 10;
+
+// Basis of the PF/FR columns
+enum FitBasis {
+	Monomial = 1, // x^j, the weights are raw-x coefficients for EvalPolynomial
+	Chebyshev, // T_j(u) on [center - scale, center + scale], see EvalChebyshev
+};
+
+struct LSKernel {
+	// sums[m] += sign * sum b_m(u), m < 2k - 1;
+	// moments[d * k + j] += sign * sum y_d * b_j(u), ys holds dim values per sample.
+	// b_m is the m-th basis function, u = (x - center) / scale. Monomial kernels
+	// expect center = 0.
+	void (*accumulate)(int k, const double* xs, const double* ys, int dim, int count, double center, double scale, double sign, double* sums, double* moments);
+	// Solve the regularized normal equations column by column and write weights[d * k + j].
+	// Monomial: (G + lambda * d * d^T) w = moments, d_j = scale^-j, raw-x coefficients.
+	// Chebyshev: (G + lambda * I) w = moments, the plain ridge on Chebyshev coefficients.
+	void (*solve)(int k, const double* sums, const double* moments, int dim, double lambda, double scale, float* weights);
+};
+
+const LSKernel& GetLSKernel(int k, FitBasis basis = Monomial);
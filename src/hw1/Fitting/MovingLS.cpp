@@ -0,0 +1,112 @@
+#include "MovingLS.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include "../../Common/TaskPool.h"
+
+namespace {
+	// Queries a task evaluates, one window walk each.
+	constexpr int QUERIES_PER_TASK = 1024;
+	// h over the distance of the farthest neighbour, which keeps a positive weight.
+	constexpr double SUPPORT_SCALE = 1.25;
+}
+
+void MLSEngine::SetNeighborCount(int count) {
+	count = std::max(count, 1);
+	if (count == neighborCount) return;
+	neighborCount = count;
+	MarkDirty();
+}
+
+void MLSEngine::SetDegree(int d) {
+	d = std::clamp(d, 0, MAX_DEGREE);
+	if (d == degree) return;
+	degree = d;
+	MarkDirty();
+}
+
+void MLSEngine::Solve(Eigen::MatrixXf& weights) {
+	int n = Size();
+	int dim = Dim();
+	std::vector<int> order(n);
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [this](int a, int b) { return xs[a] < xs[b]; });
+	sortedXs.resize(n);
+	sortedYs.resize(n, dim);
+	for (int i = 0; i < n; ++i) {
+		sortedXs[i] = xs[order[i]];
+		for (int d = 0; d < dim; ++d) {
+			sortedYs(i, d) = Y(order[i], d);
+		}
+	}
+	weights = sortedYs.cast<float>();
+}
+
+double MLSEngine::EvalAt(double x, int column, int& first) const {
+	int n = static_cast<int>(sortedXs.size());
+	int k = std::min(neighborCount, n);
+	// Slide while the sample after the window is nearer than its first one.
+	while (first + k < n && x - sortedXs[first] > sortedXs[first + k] - x) ++first;
+	int last = first + k - 1;
+
+	double h = SUPPORT_SCALE * std::max(x - sortedXs[first], sortedXs[last] - x);
+	int q = std::min(degree + 1, k);
+	if (!(h > 0.)) q = 1;
+	double invH = h > 0. ? 1. / h : 0.;
+
+	// Normal equations in u = (x_j - x) / h, the fit at x is the constant term.
+	// The Gram matrix is Hankel, G(a, b) = s[a + b].
+	double s[2 * MAX_DEGREE + 1] = {};
+	double m[MAX_DEGREE + 1] = {};
+	for (int j = first; j <= last; ++j) {
+		double u = (sortedXs[j] - x) * invH;
+		double r = 1. - u * u;
+		double w = h > 0. ? r * r : 1.;
+		double y = sortedYs(j, column);
+		double p = w;
+		for (int a = 0; a < 2 * q - 1; ++a) {
+			s[a] += p;
+			if (a < q) m[a] += p * y;
+			p *= u;
+		}
+	}
+	Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, MAX_DEGREE + 1, MAX_DEGREE + 1> gram(q, q);
+	Eigen::Matrix<double, Eigen::Dynamic, 1, 0, MAX_DEGREE + 1, 1> moments(q);
+	for (int a = 0; a < q; ++a) {
+		for (int b = 0; b < q; ++b) {
+			gram(a, b) = s[a + b];
+		}
+		moments(a) = m[a];
+	}
+	// Neighbours sharing abscissas can leave fewer distinct points than q,
+	// the pivoted LDL^T still returns a solution.
+	Eigen::Matrix<double, Eigen::Dynamic, 1, 0, MAX_DEGREE + 1, 1> c = gram.ldlt().solve(moments);
+	return std::isfinite(c(0)) ? c(0) : m[0] / s[0];
+}
+
+void MLSEngine::Eval(const float* xs, float* ys, int count, int column) {
+	Weights();
+	int n = static_cast<int>(sortedXs.size());
+	if (n == 0) {
+		std::fill(ys, ys + count, 0.f);
+		return;
+	}
+	int k = std::min(neighborCount, n);
+	int tasks = (count + QUERIES_PER_TASK - 1) / QUERIES_PER_TASK;
+	TaskPool::Instance().ParallelFor(tasks, [&](int task) {
+		int end = std::min((task + 1) * QUERIES_PER_TASK, count);
+		int first = 0;
+		double preX = INFINITY;
+		for (int i = task * QUERIES_PER_TASK; i < end; ++i) {
+			double x = xs[i];
+			// The window of an increasing query starts at or after the previous one.
+			if (x < preX) {
+				int upper = static_cast<int>(std::lower_bound(sortedXs.begin(), sortedXs.end(), x) - sortedXs.begin());
+				first = std::clamp(upper - k, 0, n - k);
+			}
+			preX = x;
+			ys[i] = static_cast<float>(EvalAt(x, column, first));
+		}
+	});
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "FittingEngine.h"
+
+// MLS is MovingLeastSquares abbreviation. Every evaluated x gets its own
+// polynomial of the given degree, fitted to the neighborCount samples nearest
+// to x with weights (1 - (d / h)^2)^2, h a little past the farthest neighbour.
+// On a line the nearest samples are a contiguous window of the samples sorted
+// by x, so the sorted array is the search structure: increasing queries slide
+// the window forward and reuse it, others find it by binary search. A query
+// costs O(neighborCount * degree) whatever the sample count, and queries are
+// spread over the TaskPool in chunks.
+class MLSEngine : public IncrementalFit {
+public:
+	static constexpr int MAX_DEGREE = 3;
+
+	void SetNeighborCount(int neighborCount);
+	void SetDegree(int degree);
+	void Eval(const float* xs, float* ys, int count, int column = 0);
+
+protected:
+	void OnPush() override {}
+	void OnPop(double, const double*) override {}
+	void OnClear() override {}
+	// Weights() returns the samples sorted by x, a column per value column.
+	void Solve(Eigen::MatrixXf& weights) override;
+
+private:
+	// Fits from the window at first, which is moved to the neighbours of x.
+	double EvalAt(double x, int column, int& first) const;
+
+	int neighborCount{ 8 };
+	int degree{ 2 };
+	std::vector<double> sortedXs;
+	// Size() x Dim(), rows in the order of sortedXs.
+	Eigen::MatrixXd sortedYs;
+};
@@ -0,0 +1,180 @@
+#include "PolynomialEval.h"
+
+#include <algorithm>
+
+#if !defined(FITTING_NO_SIMD) && defined(__AVX2__)
+#define FITTING_AVX2
+#include <immintrin.h>
+#elif !defined(FITTING_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define FITTING_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+	inline float Horner(const float* coeffs, int coeffCount, float x) {
+		float y = coeffs[coeffCount - 1];
+		for (int j = coeffCount - 2; j >= 0; --j) {
+			y = y * x + coeffs[j];
+		}
+		return y;
+	}
+
+	// b_j = 2u * b_j+1 - b_j+2 + c_j, y = u * b_1 - b_2 + c_0
+	inline float Clenshaw(const float* coeffs, int coeffCount, float u) {
+		float b1 = 0.f;
+		float b2 = 0.f;
+		for (int j = coeffCount - 1; j >= 1; --j) {
+			float b = 2.f * u * b1 - b2 + coeffs[j];
+			b2 = b1;
+			b1 = b;
+		}
+		return u * b1 - b2 + coeffs[0];
+	}
+
+#if defined(FITTING_AVX2)
+	constexpr int LANE = 8;
+
+	inline __m256 Horner(const float* coeffs, int coeffCount, __m256 x) {
+		__m256 y = _mm256_set1_ps(coeffs[coeffCount - 1]);
+		for (int j = coeffCount - 2; j >= 0; --j) {
+#if defined(__FMA__) || defined(_MSC_VER)
+			y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(coeffs[j]));
+#else
+			y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(coeffs[j]));
+#endif
+		}
+		return y;
+	}
+
+	inline __m256 Clenshaw(const float* coeffs, int coeffCount, __m256 u) {
+		__m256 twoU = _mm256_add_ps(u, u);
+		__m256 b1 = _mm256_setzero_ps();
+		__m256 b2 = _mm256_setzero_ps();
+		for (int j = coeffCount - 1; j >= 1; --j) {
+			__m256 c = _mm256_sub_ps(_mm256_set1_ps(coeffs[j]), b2);
+#if defined(__FMA__) || defined(_MSC_VER)
+			__m256 b = _mm256_fmadd_ps(twoU, b1, c);
+#else
+			__m256 b = _mm256_add_ps(_mm256_mul_ps(twoU, b1), c);
+#endif
+			b2 = b1;
+			b1 = b;
+		}
+		return _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(u, b1), b2), _mm256_set1_ps(coeffs[0]));
+	}
+#elif defined(FITTING_NEON)
+	constexpr int LANE = 4;
+
+	inline float32x4_t Horner(const float* coeffs, int coeffCount, float32x4_t x) {
+		float32x4_t y = vdupq_n_f32(coeffs[coeffCount - 1]);
+		for (int j = coeffCount - 2; j >= 0; --j) {
+#if defined(__aarch64__)
+			y = vfmaq_f32(vdupq_n_f32(coeffs[j]), y, x);
+#else
+			y = vmlaq_f32(vdupq_n_f32(coeffs[j]), y, x);
+#endif
+		}
+		return y;
+	}
+
+	inline float32x4_t Clenshaw(const float* coeffs, int coeffCount, float32x4_t u) {
+		float32x4_t twoU = vaddq_f32(u, u);
+		float32x4_t b1 = vdupq_n_f32(0.f);
+		float32x4_t b2 = vdupq_n_f32(0.f);
+		for (int j = coeffCount - 1; j >= 1; --j) {
+			float32x4_t c = vsubq_f32(vdupq_n_f32(coeffs[j]), b2);
+#if defined(__aarch64__)
+			float32x4_t b = vfmaq_f32(c, twoU, b1);
+#else
+			float32x4_t b = vmlaq_f32(c, twoU, b1);
+#endif
+			b2 = b1;
+			b1 = b;
+		}
+		return vaddq_f32(vsubq_f32(vmulq_f32(u, b1), b2), vdupq_n_f32(coeffs[0]));
+	}
+#endif
+}
+
+void EvalPolynomial(const float* coeffs, int coeffCount, const float* xs, float* ys, int count) {
+	if (coeffCount <= 0) {
+		std::fill(ys, ys + count, 0.f);
+		return;
+	}
+
+	int i = 0;
+#if defined(FITTING_AVX2)
+	for (; i + LANE <= count; i += LANE) {
+		_mm256_storeu_ps(ys + i, Horner(coeffs, coeffCount, _mm256_loadu_ps(xs + i)));
+	}
+#elif defined(FITTING_NEON)
+	for (; i + LANE <= count; i += LANE) {
+		vst1q_f32(ys + i, Horner(coeffs, coeffCount, vld1q_f32(xs + i)));
+	}
+#endif
+	for (; i < count; ++i) {
+		ys[i] = Horner(coeffs, coeffCount, xs[i]);
+	}
+}
+
+void EvalPolynomialRange(const float* coeffs, int coeffCount, float left, float right, float delta, float* ys, int count) {
+	if (coeffCount <= 0) {
+		std::fill(ys, ys + count, 0.f);
+		return;
+	}
+
+	int i = 0;
+#if defined(FITTING_AVX2)
+	const __m256 offset = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256 vLeft = _mm256_set1_ps(left);
+	const __m256 vRight = _mm256_set1_ps(right);
+	const __m256 vDelta = _mm256_set1_ps(delta);
+	for (; i + LANE <= count; i += LANE) {
+		__m256 index = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), offset);
+		__m256 x = _mm256_min_ps(_mm256_add_ps(vLeft, _mm256_mul_ps(index, vDelta)), vRight);
+		_mm256_storeu_ps(ys + i, Horner(coeffs, coeffCount, x));
+	}
+#elif defined(FITTING_NEON)
+	const float offsetInit[LANE] = { 0, 1, 2, 3 };
+	const float32x4_t offset = vld1q_f32(offsetInit);
+	const float32x4_t vLeft = vdupq_n_f32(left);
+	const float32x4_t vRight = vdupq_n_f32(right);
+	const float32x4_t vDelta = vdupq_n_f32(delta);
+	for (; i + LANE <= count; i += LANE) {
+		float32x4_t index = vaddq_f32(vdupq_n_f32(static_cast<float>(i)), offset);
+		float32x4_t x = vminq_f32(vaddq_f32(vLeft, vmulq_f32(index, vDelta)), vRight);
+		vst1q_f32(ys + i, Horner(coeffs, coeffCount, x));
+	}
+#endif
+	for (; i < count; ++i) {
+		ys[i] = Horner(coeffs, coeffCount, std::min(left + i * delta, right));
+	}
+}
+
+void EvalChebyshev(const float* coeffs, int coeffCount, float center, float scale, const float* xs, float* ys, int count) {
+	if (coeffCount <= 0) {
+		std::fill(ys, ys + count, 0.f);
+		return;
+	}
+
+	const float invScale = 1.f / scale;
+	int i = 0;
+#if defined(FITTING_AVX2)
+	const __m256 vCenter = _mm256_set1_ps(center);
+	const __m256 vInvScale = _mm256_set1_ps(invScale);
+	for (; i + LANE <= count; i += LANE) {
+		__m256 u = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(xs + i), vCenter), vInvScale);
+		_mm256_storeu_ps(ys + i, Clenshaw(coeffs, coeffCount, u));
+	}
+#elif defined(FITTING_NEON)
+	const float32x4_t vCenter = vdupq_n_f32(center);
+	const float32x4_t vInvScale = vdupq_n_f32(invScale);
+	for (; i + LANE <= count; i += LANE) {
+		float32x4_t u = vmulq_f32(vsubq_f32(vld1q_f32(xs + i), vCenter), vInvScale);
+		vst1q_f32(ys + i, Clenshaw(coeffs, coeffCount, u));
+	}
+#endif
+	for (; i < count; ++i) {
+		ys[i] = Clenshaw(coeffs, coeffCount, (xs[i] - center) * invScale);
+	}
+}
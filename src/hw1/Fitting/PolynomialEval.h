@@ -0,0 +1,17 @@
+#pragma once
+
+// Batched evaluation of y = sum coeffs[j] * x^j with Horner's scheme,
+// vectorized across x (AVX2 / NEON, scalar otherwise). Define FITTING_NO_SIMD
+// to force the scalar path.
+
+// ys[i] = p(xs[i]), i in [0, count)
+void EvalPolynomial(const float* coeffs, int coeffCount, const float* xs, float* ys, int count);
+
+// ys[i] = p(min(left + i * delta, right)), i in [0, count)
+void EvalPolynomialRange(const float* coeffs, int coeffCount, float left, float right, float delta, float* ys, int count);
+
+// Clenshaw's recurrence for y = sum coeffs[j] * T_j(u), u = (x - center) / scale,
+// vectorized the same way. The coefficients of an orthogonal fit stay O(1),
+// so float keeps the accuracy that monomial coefficients lose.
+// ys[i] = p(xs[i]), i in [0, count)
+void EvalChebyshev(const float* coeffs, int coeffCount, float center, float scale, const float* xs, float* ys, int count);
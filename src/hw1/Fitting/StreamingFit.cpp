@@ -0,0 +1,83 @@
+#include "StreamingFit.h"
+#include "LSKernels.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+	// Samples converted to double at a time, on the stack.
+	constexpr int CHUNK = 256;
+}
+
+StreamingLSFit::StreamingLSFit(int fitBaseCount, float lambda) : lambda{ lambda } {
+	Reset(fitBaseCount);
+}
+
+void StreamingLSFit::Reset(int fitBaseCount) {
+	k = std::max(fitBaseCount, 1);
+	scale = 1;
+	count = 0;
+	sums.setZero(2 * k - 1);
+	moments.setZero(k);
+	dirty = true;
+}
+
+void StreamingLSFit::SetLambda(float l) {
+	if (l == lambda) return;
+	lambda = l;
+	dirty = true;
+}
+
+void StreamingLSFit::Push(float x, float y) {
+	Push(&x, &y, 1);
+}
+
+void StreamingLSFit::Push(const float* xs, const float* ys, int n) {
+	for (int begin = 0; begin < n; begin += CHUNK) {
+		Accumulate(xs + begin, ys + begin, std::min(CHUNK, n - begin), 1.);
+	}
+	count += n;
+}
+
+void StreamingLSFit::Pop(float x, float y) {
+	assert(count > 0);
+	Accumulate(&x, &y, 1, -1.);
+	--count;
+}
+
+void StreamingLSFit::Accumulate(const float* xs, const float* ys, int n, double sign) {
+	double chunkXs[CHUNK];
+	double chunkYs[CHUNK];
+	double maxX = 0;
+	for (int i = 0; i < n; ++i) {
+		chunkXs[i] = xs[i];
+		chunkYs[i] = ys[i];
+		maxX = std::max(maxX, std::abs(chunkXs[i]));
+	}
+	if (maxX > scale) Rescale(maxX);
+
+	GetLSKernel(k).accumulate(k, chunkXs, chunkYs, 1, n, 0., scale, sign, sums.data(), moments.data());
+	dirty = true;
+}
+
+void StreamingLSFit::Rescale(double newScale) {
+	// (x / scale)^m = (x / newScale)^m * r^m, r = newScale / scale.
+	double r = newScale / scale;
+	double p = 1.;
+	for (int m = 0; m < 2 * k - 1; ++m) {
+		if (m < k) moments(m) /= p;
+		sums(m) /= p;
+		p *= r;
+	}
+	scale = newScale;
+}
+
+const Eigen::VectorXf& StreamingLSFit::Weights() {
+	if (!dirty) return weights;
+	dirty = false;
+
+	weights.resize(k);
+	GetLSKernel(k).solve(k, sums.data(), moments.data(), 1, lambda, scale, weights.data());
+	return weights;
+}
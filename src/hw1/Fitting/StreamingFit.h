@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Eigen/Dense"
+
+// PF/FR over a stream of samples that is never stored: only the power sums of
+// the Gram matrix and the right-hand side are kept, O(k) memory and O(k) per
+// sample, k = fitBaseCount. Weights() may be queried at any moment for O(k^3).
+// Same basis and FR semantics as LSEngine, columns are (x / scale)^j; when a
+// sample outside [-scale, scale] arrives the accumulated sums are rescaled
+// exactly instead of being rebuilt from the samples.
+class StreamingLSFit {
+public:
+	explicit StreamingLSFit(int fitBaseCount = 4, float lambda = 0);
+
+	// Drops every sample.
+	void Reset(int fitBaseCount);
+	// FR adds lambda to every entry of the Gram matrix, lambda = 0 is PF.
+	void SetLambda(float lambda);
+
+	void Push(float x, float y);
+	void Push(const float* xs, const float* ys, int count);
+	// Remove a sample pushed before, e.g. the one leaving a sliding window.
+	void Pop(float x, float y);
+
+	long long Count() const { return count; }
+	// Same layout as PolynomialSolver expects, coefficients of raw x.
+	const Eigen::VectorXf& Weights();
+
+private:
+	void Rescale(double newScale);
+	void Accumulate(const float* xs, const float* ys, int count, double sign);
+
+	int k;
+	float lambda;
+	double scale{ 1 };
+	long long count{ 0 };
+	// 2k - 1 power sums, see LSKernels.h
+	Eigen::VectorXd sums;
+	Eigen::VectorXd moments;
+	Eigen::VectorXf weights;
+	bool dirty{ true };
+};
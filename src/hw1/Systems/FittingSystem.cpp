@@ -1,17 +1,19 @@
 #include "FittingSystem.h"
+#include "../Fitting/Barycentric.h"
+#include "../Fitting/BSplineFit.h"
+#include "../Fitting/CompactRBF.h"
+#include "../Fitting/CrossValidation.h"
+#include "../Fitting/FastGauss.h"
+#include "../Fitting/FittingEngine.h"
+#include "../Fitting/FittingKernels.h"
+#include "../Fitting/MovingLS.h"
+#include "../Fitting/PolynomialEval.h"
+#include "../../Common/TaskPool.h"
+#include "../../Common/Tessellate.h"
+#include <cstdio>
 
 using namespace Ubpa;
 
-Eigen::MatrixXf operator+ (const Eigen::MatrixXf& matrix, float v) {
-	Eigen::MatrixXf m(matrix);
-	for (int i = 0; i < matrix.rows(); ++i) {
-		for (int j = 0; j < matrix.cols(); ++j) {
-			m(i, j) += v;
-		}
-	}
-	return m;
-}
-
 ImVec2 operator+ (const ImVec2& v1, const ImVec2& v2) {
 	return ImVec2(v1.x + v2.x, v1.y + v2.y);
 }
@@ -25,318 +27,411 @@ float Len(const ImVec2& v2, const ImVec2& v1) {
 	return std::sqrt(v.x * v.x + v.y * v.y);
 }
 
-void Draw(const std::vector<ImVec2>& points, const ImVec2& canvasOrigin, const ImVec2& canvasSize, ImDrawList* drawList, const ImU32& color) {
-	if (points.size() < 1) return;
-	
-	ImVec2 canvasDiagonal = canvasOrigin + canvasSize;
-	ImVec2 prePoint = ImVec2(canvasOrigin.x + points[0].x, canvasDiagonal.y - points[0].y);
-	for (int i = 1; i < points.size(); ++i) {
-		ImVec2 curPoint = ImVec2(canvasOrigin.x + points[i].x, canvasDiagonal.y - points[i].y);
-		drawList->AddLine(prePoint, curPoint, color, 2.0);
-		prePoint = std::move(curPoint);
-	}
-}
-
-float PolynomialSolver(float x, const Eigen::VectorXf coeffs) {
-	int maxPow = coeffs.rows();
-	float y = 0;
-	for (int i = 0; i < maxPow; ++i) {
-		y += coeffs(i) * pow(x, i);
-	}
-	return y;
-}
+// Chord error of the drawn polylines, in pixels.
+constexpr float CURVE_TOLERANCE = 0.25f;
+// Uniform pieces a curve starts from before adaptive bisection.
+constexpr int CURVE_SEGMENTS = 32;
 
-// PI is PolynomialInterpolate abbreviation
-Eigen::VectorXf PIWeight(const std::vector<float>& xs, const std::vector<float>& ys) {
-	assert(xs.size() == ys.size());
-	int n = xs.size();
-
-	Eigen::MatrixXf m(n, n);
-	Eigen::VectorXf y(n);
+// One polyline per curve.
+void Draw(const std::vector<ImVec2>& points, const ImVec2& canvasOrigin, const ImVec2& canvasSize, ImDrawList* drawList, const ImU32& color) {
+	if (points.size() < 2) return;
 
-	for (int i = 0; i < n; ++i) {
-		for (int j = 0; j < n; ++j) {
-			m(i, j) = pow(xs[i], j);
-		}
-		y(i) = ys[i];
+	ImVec2 canvasDiagonal = canvasOrigin + canvasSize;
+	std::vector<ImVec2> screen(points.size());
+	for (int i = 0; i < points.size(); ++i) {
+		screen[i] = ImVec2(canvasOrigin.x + points[i].x, canvasDiagonal.y - points[i].y);
 	}
-
-	return m.inverse() * y;
+	drawList->AddPolyline(screen.data(), screen.size(), color, false, 2.0f);
 }
 
-// PI is PolynomialInterpolate abbreviation
-std::vector<ImVec2> PIPredict(float left, float right, float delta, const std::vector<float>& xs, const std::vector<float>& ys)
+// Fitted values at samples, values gets one column per weight column.
+void PolynomialPredict(const std::vector<float>& samples, const Eigen::MatrixXf& w, Eigen::MatrixXf& values)
 {
-	const Eigen::VectorXf& w = PIWeight(xs, ys);
-	int size = ceil((right - left) / delta);
-	std::vector<ImVec2> fitPoints(size);
-
-	float x = left;
-	for (int i = 0; i < fitPoints.size(); ++i) {
-		x = std::min(x, right);
-		fitPoints[i][0] = x;
-		fitPoints[i][1] = PolynomialSolver(x, w);
-		x += delta;
+	values.resize(samples.size(), w.cols());
+	for (int d = 0; d < w.cols(); ++d) {
+		EvalPolynomial(w.col(d).data(), w.rows(), samples.data(), values.col(d).data(), samples.size());
 	}
-
-	return fitPoints;
-}
-
-// PI is PolynomialInterpolate abbreviation
-void _PI(CanvasData* data, const ImVec2& canvasOrigin, const ImVec2& canvasSize, ImDrawList* drawList) {
-	const std::vector<ImVec2>& ps = PIPredict(canvasOrigin.x, canvasOrigin.x + canvasSize.x, data->delta, data->xs, data->ys);
-	Draw(ps, canvasOrigin, canvasSize, drawList, IM_COL32(255, 0, 0, 255));
-}
-
-float Gauss(float x, float u = 0, float invSigma = 1) {
-	return exp(-0.5 * pow((x - u) * invSigma, 2));
 }
 
-float GaussSolver(const std::vector<float>& xs, float x, float sigma, const Eigen::VectorXf& coeffs)
+// PF/FR prediction, the weights are in the engine's basis.
+void LSPredict(const std::vector<float>& samples, LSEngine& engine, Eigen::MatrixXf& values)
 {
-	float invSigma = 1. / sigma;
-	float y = 0;
-
-	y += coeffs(0);
-	for (int i = 0; i < xs.size(); ++i) {
-		y += coeffs(i + 1) * Gauss(x, xs[i], invSigma);
+	if (engine.Basis() == Monomial) {
+		PolynomialPredict(samples, engine.Weights(), values);
+		return;
+	}
+	const Eigen::MatrixXf& w = engine.Weights();
+	values.resize(samples.size(), w.cols());
+	for (int d = 0; d < w.cols(); ++d) {
+		EvalChebyshev(w.col(d).data(), w.rows(), engine.Center(), engine.Scale(), samples.data(), values.col(d).data(), samples.size());
 	}
-	return y;
 }
 
-// Here sigma is a manual constant.
-Eigen::VectorXf GaussWeight(const std::vector<float>& xs, const std::vector<float>& ys, const std::vector<float>& us, float sigma)
+// Sample an engine which evaluates itself, e.g. BarycentricEngine or CompactGIEngine.
+template<typename Engine>
+void EnginePredict(const std::vector<float>& samples, Engine& engine, Eigen::MatrixXf& values)
 {
-	int n = us.size();
-	// Need add a constant
-	Eigen::MatrixXf m(n + 1, n + 1);
-	Eigen::VectorXf y(n + 1);
-
-	float invSigma = 1.0 / sigma;
-
-	for (int i = 0; i < n; ++i) {
-		m(i, 0) = 1;
-		for (int j = 0; j < n; ++j) {
-			m(i, j + 1) = Gauss(xs[i], us[j], invSigma);
-		}
-		y(i) = ys[i];
-	}
-
-	// Add constraint(end two points center)
-	m(n, 0) = 1;
-	float centerX = (xs[n - 2] + xs[n - 1]) * 0.5f;
-	float centerY = (ys[n - 2] + ys[n - 1]) * 0.5f;
-
-	for (int i = 0; i < n; ++i) {
-		m(n, i + 1) = Gauss(centerX, us[i], invSigma);
+	values.resize(samples.size(), engine.Dim());
+	for (int d = 0; d < engine.Dim(); ++d) {
+		engine.Eval(samples.data(), values.col(d).data(), samples.size(), d);
 	}
-	y(n) = centerY;
-
-	return m.inverse() * y;
 }
 
 // GI is GaussInterpolate abbreviation
-std::vector<ImVec2> GIPredict(float left, float right, float delta, const std::vector<float>& xs, const std::vector<float>& ys, const std::vector<float>& us, float sigma)
+void GIPredict(const std::vector<float>& samples, const float* us, int count, float sigma, const Eigen::MatrixXf& w, Eigen::MatrixXf& values)
 {
-	const Eigen::VectorXf& w = GaussWeight(xs, ys, us, sigma);
-	int size = ceil((right - left) / delta);
-	std::vector<ImVec2> fitPoints(size);
-
-	float x = left;
-	for (int i = 0; i < fitPoints.size(); ++i) {
-		x = std::min(x, right);
-		fitPoints[i][0] = x;
-		fitPoints[i][1] = GaussSolver(xs, x, sigma, w);
-		x += delta;
+	values.resize(samples.size(), w.cols());
+	for (int d = 0; d < w.cols(); ++d) {
+		EvalGauss(us, count, sigma, w.col(d).data(), samples.data(), values.col(d).data(), samples.size());
 	}
-
-	return fitPoints;
-}
-
-void GI(CanvasData* data, const ImVec2& canvasOrigin, const ImVec2& canvasSize, ImDrawList* drawList, float sigma) {
-	const std::vector<ImVec2>& ps = GIPredict(canvasOrigin.x, canvasOrigin.x + canvasSize.x, data->delta, data->xs, data->ys, data->xs, data->sigma);
-	Draw(ps, canvasOrigin, canvasSize, drawList, IM_COL32(0, 255, 0, 255));
 }
 
-// PF is PolynomialFit abbreviation
-Eigen::VectorXf PFWeight(const std::vector<float>& xs, const std::vector<float>& ys, int fitBaseCount) {
-	int n = xs.size();
-	int equationCount = xs.size();
-
-	if (fitBaseCount >= 2 && fitBaseCount <= n) {
-		n = fitBaseCount;
-	}
-
-	Eigen::MatrixXf m(equationCount, n);
-	Eigen::VectorXf y(equationCount);
-
-	for (int i = 0; i < equationCount; ++i) {
-		for (int j = 0; j < n; j++)
+enum FitType {
+	FitPI = 0,
+	FitGI,
+	FitPF,
+	FitFR,
+	FitBS,
+	FitMLS,
+	FitTypeCount,
+};
+
+const char* FIT_SWITCHS[FitTypeCount] = {
+	"enablePolynomialInterpolate",
+	"enableGaussInterpolate",
+	"enablePolynomialFit",
+	"enableRidgeFit",
+	"enableBSplineFit",
+	"enableMovingLS",
+};
+
+const ImU32 FIT_COLORS[FitTypeCount] = {
+	IM_COL32(255, 0, 0, 255),
+	IM_COL32(0, 255, 0, 255),
+	IM_COL32(0, 0, 255, 255),
+	IM_COL32(200, 180, 255, 255),
+	IM_COL32(255, 160, 0, 255),
+	IM_COL32(0, 200, 120, 255),
+};
+
+// Factorizations are kept between frames, see Fitting/FittingEngine.h
+struct FittingEngines {
+	// PI is PolynomialInterpolate abbreviation
+	PIEngine pi;
+	// GI is GaussInterpolate abbreviation
+	GIEngine gi;
+	// PF is PolynomialFit abbreviation
+	LSEngine pf;
+	// FR is FittingRidge abbreviation
+	LSEngine fr;
+	// BS is BSplineFit abbreviation
+	BSplineFitEngine bs;
+	// MLS is MovingLeastSquares abbreviation
+	MLSEngine mls;
+	// PI in barycentric form
+	BarycentricEngine barycentric;
+	// GI with a compactly supported kernel
+	CompactGIEngine compactGi;
+	// Evaluates gi's weights for many samples at once, one transform per value column
+	std::vector<FastGaussTransform> fgts;
+
+	// Fit every value column over xs. Expansions that only depend on the fit,
+	// like the fast Gauss transform, are built here once per refit.
+	void Fit(FitType type, const CanvasData* data, const float* xs, const float* const* columns, int dim, int count) {
+		switch (type)
 		{
-			m(i, j) = pow(xs[i], j);
+		case FitPI:
+			if (data->piMode == Barycentric) {
+				barycentric.Sync(xs, columns, dim, count);
+				return;
+			}
+			pi.Sync(xs, columns, dim, count);
+			return;
+		case FitGI:
+			if (data->giMode == GaussCompact) {
+				compactGi.SetSigma(data->sigma);
+				compactGi.Sync(xs, columns, dim, count);
+				return;
+			}
+			gi.SetSigma(data->sigma);
+			gi.Sync(xs, columns, dim, count);
+			if (data->giMode == GaussFast) {
+				fgts.resize(dim);
+				for (int d = 0; d < dim; ++d) {
+					fgts[d].Build(xs, count, gi.Weights().col(d).data(), data->sigma, data->fgtTolerance);
+				}
+			}
+			return;
+		case FitPF:
+			pf.SetFitBaseCount(data->fitBaseCount);
+			pf.SetBasis((FitBasis)data->fitBasis);
+			pf.Sync(xs, columns, dim, count);
+			return;
+		case FitFR:
+			fr.SetFitBaseCount(data->fitBaseCount);
+			fr.SetLambda(data->lambda);
+			fr.SetBasis((FitBasis)data->fitBasis);
+			fr.Sync(xs, columns, dim, count);
+			return;
+		case FitBS:
+			bs.SetKnotCount(data->knotCount);
+			bs.Sync(xs, columns, dim, count);
+			return;
+		default:
+			mls.SetNeighborCount(data->mlsNeighbors);
+			mls.SetDegree(data->mlsDegree);
+			mls.Sync(xs, columns, dim, count);
+			return;
 		}
-		y(i) = ys[i];
 	}
 
-	return (m.transpose() * m).inverse() * m.transpose() * y;
-}
-
-std::vector<ImVec2> PFPredict(float left, float right, float delta, const std::vector<float>& xs, const std::vector<float>& ys, int fitBaseCount = 4) {
-	Eigen::VectorXf w = std::move(PFWeight(xs, ys, fitBaseCount));
-	int size = ceil((right - left) / delta);
-	std::vector<ImVec2> fitPoints(size);
-
-	float x = left;
-	for (int i = 0; i < fitPoints.size(); ++i) {
-		x = std::min(x, right);
-		fitPoints[i][0] = x;
-		fitPoints[i][1] = PolynomialSolver(x, w);
-		x += delta;
-	}
-
-	return fitPoints;
-}
-
-void PF(CanvasData* data, ImDrawList* drawList, const ImVec2& canvasOrigin, const ImVec2& canvasSize) {
-	const std::vector<ImVec2>& ps = PFPredict(canvasOrigin.x, canvasOrigin.x + canvasSize.x, data->delta, data->xs, data->ys, data->fitBaseCount);
-	Draw(ps, canvasOrigin, canvasSize, drawList, IM_COL32(0, 0, 255, 255));
-}
-
-// FR is FittingRidge abbreviation
-Eigen::VectorXf FRWeight(const std::vector<float>& xs, const std::vector<float>& ys, int fitBaseCount, float lambda)
-{
-	int n = xs.size();
-	int equationCount = xs.size();
-	if (2 <= fitBaseCount && fitBaseCount <= n) {
-		n = fitBaseCount;
-	}
-
-	Eigen::MatrixXf m(equationCount, n);
-	Eigen::VectorXf y(equationCount);
-
-	for (int i = 0; i < equationCount; ++i) {
-		for (int j = 0; j < n; j++)
+	// Evaluate the last Fit at samples, values(i, d) is column d at samples[i].
+	void Predict(FitType type, const CanvasData* data, const float* xs, int count, const std::vector<float>& samples, Eigen::MatrixXf& values) {
+		switch (type)
 		{
-			m(i, j) = pow(xs[i], j);
+		case FitPI:
+			if (data->piMode == Barycentric) {
+				EnginePredict(samples, barycentric, values);
+				return;
+			}
+			PolynomialPredict(samples, pi.Weights(), values);
+			return;
+		case FitGI:
+			if (data->giMode == GaussCompact) {
+				EnginePredict(samples, compactGi, values);
+				return;
+			}
+			if (data->giMode == GaussFast) {
+				int dim = static_cast<int>(fgts.size());
+				values.resize(samples.size(), dim);
+				for (int d = 0; d < dim; ++d) {
+					fgts[d].Eval(samples.data(), values.col(d).data(), samples.size());
+				}
+				return;
+			}
+			GIPredict(samples, xs, count, data->sigma, gi.Weights(), values);
+			return;
+		case FitPF:
+			LSPredict(samples, pf, values);
+			return;
+		case FitFR:
+			LSPredict(samples, fr, values);
+			return;
+		case FitBS:
+			EnginePredict(samples, bs, values);
+			return;
+		default:
+			EnginePredict(samples, mls, values);
+			return;
 		}
-		y(i) = ys[i];
 	}
-
-	return ((m.transpose() * m) + lambda).inverse() * m.transpose() * y;
-}
-
-std::vector<ImVec2> FRPredict(float left, float right, float delta, const std::vector<float>& xs, const std::vector<float>& ys, int fitBaseCount = 4, float lambda = 0.1) {
-	const Eigen::VectorXf& w = FRWeight(xs, ys, fitBaseCount, lambda);
-	int size = ceil((right - left) / delta);
-	std::vector<ImVec2> fitPoints(size);
-
-	float x = left;
-	for (int i = 0; i < fitPoints.size(); ++i) {
-		x = std::min(x, right);
-		fitPoints[i][0] = x;
-		fitPoints[i][1] = PolynomialSolver(x, w);
-		x += delta;
-	}
-
-	return fitPoints;
-}
-
-void FR(CanvasData* data, ImDrawList* drawList, const ImVec2& canvasOrigin, const ImVec2& canvasSize)
-{
-	const std::vector<ImVec2>& ps = FRPredict(canvasOrigin.x, canvasOrigin.x + canvasSize.x, data->delta, data->xs, data->ys, data->fitBaseCount, data->lambda);
-	Draw(ps, canvasOrigin, canvasSize, drawList, IM_COL32(200, 180, 255, 255));
-}
-
-std::vector<float> Parameterization2(const std::vector<float>& xs, const std::vector<float>& ys, ParamMode mode, float tInterval) {
-	int n = xs.size();
-	std::vector<float> t(n);
-	if (n < 1) return t;
-
-	switch (mode)
-	{
-	case Uniform:
-		t[0] = 0;
-		for (int i = 1; i < n; ++i) {
-			t[i] = t[i - 1] + tInterval;
+};
+
+// y = f(x)
+static FittingEngines fnEngines;
+// (x, y) = f(t), both columns share every factorization
+static FittingEngines curveEngines;
+
+// Everything a fitted curve depends on. Fields the fit type does not use stay zero.
+struct FitKey {
+	int version{ -1 };
+	int fitBaseCount{ 0 };
+	int paramMode{ 0 };
+	int piMode{ 0 };
+	int giMode{ 0 };
+	int fitBasis{ 0 };
+	int knotCount{ 0 };
+	int mlsNeighbors{ 0 };
+	int mlsDegree{ 0 };
+	float sigma{ 0 };
+	float fgtTolerance{ 0 };
+	float lambda{ 0 };
+	float delta{ 0 };
+	float tDelta{ 0 };
+	float tInterval{ 0 };
+	float left{ 0 };
+	float right{ 0 };
+
+	FitKey() = default;
+	FitKey(FitType type, bool isCurve, const CanvasData* data, const ImVec2& canvasOrigin, const ImVec2& canvasSize) {
+		version = data->version;
+		if (type == FitPI) {
+			piMode = data->piMode;
 		}
-		break;
-	case Chordal:
-		t[0] = 0;
-		for (int i = 1; i < n; ++i) {
-			float xDiff = xs[i] - xs[i - 1];
-			float yDiff = ys[i] - ys[i - 1];
-			t[i] = t[i - 1] + std::sqrt(xDiff * xDiff + yDiff * yDiff);
+		if (type == FitGI) {
+			giMode = data->giMode;
+			sigma = data->sigma;
+			if (giMode == GaussFast) {
+				fgtTolerance = data->fgtTolerance;
+			}
 		}
-		break;
-	case Centripetal:
-		t[0] = 0;
-		for (int i = 1; i < n; ++i) {
-			float xDiff = xs[i] - xs[i - 1];
-			float yDiff = ys[i] - ys[i - 1];
-			t[i] = t[i - 1] + pow(xDiff * xDiff + yDiff * yDiff, 0.25);
+		if (type == FitPF || type == FitFR) {
+			fitBaseCount = data->fitBaseCount;
+			fitBasis = data->fitBasis;
 		}
-		break;
-	}
-	return t;
-}
-
-void CurveFit(CanvasData* data, ImDrawList* drawList, const ImVec2& canvasOrigin, const ImVec2& canvasSize) {
-	const std::vector<float>& ts = Parameterization2(data->xs, data->ys, (ParamMode)(data->paramMode), data->tInterval);
-	if (data->switchs["enablePolynomialInterpolate"]) {
-		const std::vector<ImVec2>& xs = PIPredict(ts[0], ts[ts.size() - 1], data->tDelta, ts, data->xs);
-		const std::vector<ImVec2>& ys = PIPredict(ts[0], ts[ts.size() - 1], data->tDelta, ts, data->ys);
-		assert(xs.size() == ys.size());
-
-		std::vector<ImVec2> points(xs.size());
-		for (int i = 0; i < xs.size(); ++i) {
-			points[i][0] = xs[i][1];
-			points[i][1] = ys[i][1];
+		if (type == FitFR) {
+			lambda = data->lambda;
+		}
+		if (type == FitBS) {
+			knotCount = data->knotCount;
+		}
+		if (type == FitMLS) {
+			mlsNeighbors = data->mlsNeighbors;
+			mlsDegree = data->mlsDegree;
+		}
+		if (isCurve) {
+			paramMode = data->paramMode;
+			tDelta = data->tDelta;
+			tInterval = data->tInterval;
+		}
+		else {
+			delta = data->delta;
+			left = canvasOrigin.x;
+			right = canvasOrigin.x + canvasSize.x;
 		}
-
-		Draw(points, canvasOrigin, canvasSize, drawList, IM_COL32(255, 0, 0, 255));
 	}
 
-	if (data->switchs["enableGaussInterpolate"]) {
-		const std::vector<ImVec2>& xs = GIPredict(ts[0], ts[ts.size() - 1], data->tDelta, ts, data->xs, ts, data->sigma);
-		const std::vector<ImVec2>& ys = GIPredict(ts[0], ts[ts.size() - 1], data->tDelta, ts, data->ys, ts, data->sigma);
-		assert(xs.size() == ys.size());
-
-		std::vector<ImVec2> points(xs.size());
-		for (int i = 0; i < xs.size(); ++i) {
-			points[i][0] = xs[i][1];
-			points[i][1] = ys[i][1];
+	bool operator==(const FitKey& key) const {
+		return version == key.version && fitBaseCount == key.fitBaseCount && paramMode == key.paramMode
+			&& piMode == key.piMode && giMode == key.giMode && fitBasis == key.fitBasis && knotCount == key.knotCount
+			&& mlsNeighbors == key.mlsNeighbors && mlsDegree == key.mlsDegree && sigma == key.sigma && fgtTolerance == key.fgtTolerance && lambda == key.lambda && delta == key.delta && tDelta == key.tDelta
+			&& tInterval == key.tInterval && left == key.left && right == key.right;
+	}
+};
+
+// Fitted curve, reused until one of its inputs changes.
+struct FitCache {
+	FitKey key;
+	std::vector<ImVec2> points;
+
+	// Return true if points must be recomputed for newKey.
+	bool NeedUpdate(const FitKey& newKey) {
+		if (key == newKey) return false;
+		key = newKey;
+		return true;
+	}
+};
+
+static FitCache fnCaches[FitTypeCount];
+static FitCache curveCaches[FitTypeCount];
+
+// Refit the enabled methods whose cache is stale, concurrently on the task pool.
+// Every method owns its engines, the tasks share nothing but read-only inputs.
+// ImGui is only touched by the main thread, drawing happens afterwards.
+void FitAll(CanvasData* data, bool isCurve, ImDrawList* drawList, const ImVec2& canvasOrigin, const ImVec2& canvasSize) {
+	FitCache* caches = isCurve ? curveCaches : fnCaches;
+	std::vector<FitType> enabled;
+	std::vector<FitType> stale;
+	for (int i = 0; i < FitTypeCount; ++i) {
+		FitType type = (FitType)i;
+		if (!data->switchs[FIT_SWITCHS[type]]) continue;
+
+		enabled.push_back(type);
+		if (caches[type].NeedUpdate(FitKey(type, isCurve, data, canvasOrigin, canvasSize))) {
+			stale.push_back(type);
 		}
-
-		Draw(points, canvasOrigin, canvasSize, drawList, IM_COL32(0, 255, 0, 255));
 	}
 
-	if (data->switchs["enablePolynomialFit"]) {
-		const std::vector<ImVec2>& xs = PFPredict(ts[0], ts[ts.size() - 1], data->tDelta, ts, data->xs, data->fitBaseCount);
-		const std::vector<ImVec2>& ys = PFPredict(ts[0], ts[ts.size() - 1], data->tDelta, ts, data->ys, data->fitBaseCount);
-		assert(xs.size() == ys.size());
-
-		std::vector<ImVec2> points(xs.size());
-		for (int i = 0; i < xs.size(); ++i) {
-			points[i][0] = xs[i][1];
-			points[i][1] = ys[i][1];
+	if (!stale.empty()) {
+		int n = data->xs.size();
+		// Abscissas shared by every method and the sampled range: t for a curve, x for a function.
+		// delta/tDelta are the finest step, flat parts are sampled more coarsely.
+		static ParameterizationCache paramCache;
+		const float* ts = nullptr;
+		float left, right, minStep;
+		if (isCurve) {
+			ts = paramCache.Sync(data->xs, data->ys, (ParamMode)(data->paramMode), data->tInterval).data();
+			left = ts[0];
+			right = ts[n - 1];
+			minStep = data->tDelta;
 		}
-
-		Draw(points, canvasOrigin, canvasSize, drawList, IM_COL32(0, 0, 255, 255));
+		else {
+			left = canvasOrigin.x;
+			right = canvasOrigin.x + canvasSize.x;
+			minStep = data->delta;
+		}
+		const float* columns[] = { data->xs.data(), data->ys.data() };
+
+		TaskPool::Instance().ParallelFor(stale.size(), [&](int i) {
+			FitType type = stale[i];
+			std::vector<ImVec2>& points = caches[type].points;
+			std::vector<float> samples;
+			Eigen::MatrixXf values;
+			if (isCurve) {
+				curveEngines.Fit(type, data, ts, columns, 2, n);
+			}
+			else {
+				fnEngines.Fit(type, data, data->xs.data(), columns + 1, 1, n);
+			}
+			auto curve = [&](const float* at, int count, ImVec2* ps) {
+				samples.assign(at, at + count);
+				if (isCurve) {
+					curveEngines.Predict(type, data, ts, n, samples, values);
+					for (int j = 0; j < count; ++j) {
+						ps[j] = ImVec2(values(j, 0), values(j, 1));
+					}
+				}
+				else {
+					fnEngines.Predict(type, data, data->xs.data(), n, samples, values);
+					for (int j = 0; j < count; ++j) {
+						ps[j] = ImVec2(samples[j], values(j, 0));
+					}
+				}
+			};
+			points.clear();
+			Tessellate(curve, left, right, CURVE_TOLERANCE, minStep, CURVE_SEGMENTS, points);
+		});
 	}
 
-	if (data->switchs["enableRidgeFit"]) {
-		const std::vector<ImVec2>& xs = FRPredict(ts[0], ts[ts.size() - 1], data->tDelta, ts, data->xs, data->fitBaseCount, data->lambda);
-		const std::vector<ImVec2>& ys = FRPredict(ts[0], ts[ts.size() - 1], data->tDelta, ts, data->ys, data->fitBaseCount, data->lambda);
-		assert(xs.size() == ys.size());
+	for (FitType type : enabled) {
+		Draw(caches[type].points, canvasOrigin, canvasSize, drawList, FIT_COLORS[type]);
+	}
+}
 
-		std::vector<ImVec2> points(xs.size());
-		for (int i = 0; i < xs.size(); ++i) {
-			points[i][0] = xs[i][1];
-			points[i][1] = ys[i][1];
-		}
+// Scores of the last auto tune, see Fitting/CrossValidation.h.
+static GCVCurve lambdaCurve;
+static GCVCurve sigmaCurve;
+
+// Pick FR's lambda and GI's sigma for the current samples, both sweeps are
+// cheap next to refitting once per candidate.
+void AutoTune(CanvasData* data, bool tuneLambda, bool tuneSigma) {
+	int n = data->xs.size();
+	if (n < 3) return;
+	bool isCurve = data->switchs["enableCurve"];
+	static ParameterizationCache paramCache;
+	const float* columns[] = { data->xs.data(), data->ys.data() };
+	const float* xs = isCurve ? paramCache.Sync(data->xs, data->ys, (ParamMode)(data->paramMode), data->tInterval).data() : data->xs.data();
+	const float* const* values = isCurve ? columns : columns + 1;
+	int dim = isCurve ? 2 : 1;
+	if (tuneLambda) {
+		LSEngine& fr = (isCurve ? curveEngines : fnEngines).fr;
+		fr.SetFitBaseCount(data->fitBaseCount);
+		fr.SetBasis((FitBasis)data->fitBasis);
+		fr.Sync(xs, values, dim, n);
+		lambdaCurve = fr.SweepLambda(LogSpace(1e-4f, 1e2f, 200));
+		data->lambda = lambdaCurve.Best(data->lambda);
+	}
+	if (tuneSigma) {
+		sigmaCurve = SweepSigma(xs, values, dim, n, LogSpace(1.f, 100.f, 100));
+		data->sigma = sigmaCurve.Best(data->sigma);
+	}
+}
 
-		Draw(points, canvasOrigin, canvasSize, drawList, IM_COL32(200, 180, 255, 255));
+// log10 of the scores over the candidates, unscored candidates at the top.
+void PlotCurve(const char* label, const GCVCurve& curve) {
+	if (curve.best == -1) return;
+	std::vector<float> logScores(curve.scores.size());
+	float top = -INFINITY;
+	for (int i = 0; i < logScores.size(); ++i) {
+		logScores[i] = std::log10(curve.scores[i]);
+		if (std::isfinite(logScores[i])) top = std::max(top, logScores[i]);
+	}
+	for (float& s : logScores) {
+		if (!std::isfinite(s)) s = top;
 	}
+	char overlay[64];
+	std::snprintf(overlay, sizeof(overlay), "best %.4g", curve.candidates[curve.best]);
+	ImGui::PlotLines(label, logScores.data(), logScores.size(), 0, overlay, FLT_MAX, FLT_MAX, ImVec2(200, 40));
 }
 
 void DrawLine(CanvasData* data, ImU32 color, const ImVec2& canvasOrigin, const ImVec2& canvasSize, ImDrawList* drawList)
@@ -386,6 +481,10 @@ void FittingSystem::OnUpdate(UECS::Schedule& schedule)
 			ImGui::Checkbox("enablePolynomialFit", &data->switchs["enablePolynomialFit"]);
 			ImGui::SameLine(0);
 			ImGui::Checkbox("enableRidgeFit", &data->switchs["enableRidgeFit"]);
+			ImGui::SameLine(0);
+			ImGui::Checkbox("enableBSplineFit", &data->switchs["enableBSplineFit"]);
+			ImGui::SameLine(0);
+			ImGui::Checkbox("enableMovingLS", &data->switchs["enableMovingLS"]);
 			ImGui::Checkbox("enableLine", &data->switchs["enableLine"]);
 			ImGui::Checkbox("enableCurve", &data->switchs["enableCurve"]);
 
@@ -395,6 +494,15 @@ void FittingSystem::OnUpdate(UECS::Schedule& schedule)
 			ImGui::SliderInt("fitBaseCount", &data->fitBaseCount, 2, 10);
 			ImGui::SameLine(0);
 			ImGui::SliderFloat("lambda", &data->lambda, 0.001, 0.4, "%.2f");
+			ImGui::SameLine(0);
+			bool tuneLambda = ImGui::Button("autoLambda");
+			ImGui::SameLine(0);
+			bool tuneSigma = ImGui::Button("autoSigma");
+			ImGui::SameLine(0);
+			ImGui::SliderInt("knotCount", &data->knotCount, 2, 64);
+			ImGui::SliderInt("mlsNeighbors", &data->mlsNeighbors, 2, 64);
+			ImGui::SameLine(0);
+			ImGui::SliderInt("mlsDegree", &data->mlsDegree, 0, MLSEngine::MAX_DEGREE);
 
 			ImGui::PushItemWidth(60);
 			ImGui::InputFloat("delta", &data->delta);
@@ -409,6 +517,29 @@ void FittingSystem::OnUpdate(UECS::Schedule& schedule)
 			ImGui::SameLine(0);
 			ImGui::RadioButton("centripetal", &data->paramMode, 3);
 
+			ImGui::RadioButton("vandermonde", &data->piMode, 1);
+			ImGui::SameLine(0);
+			ImGui::RadioButton("barycentric", &data->piMode, 2);
+			ImGui::SameLine(0);
+			ImGui::RadioButton("dense", &data->giMode, 1);
+			ImGui::SameLine(0);
+			ImGui::RadioButton("compact", &data->giMode, 2);
+			ImGui::SameLine(0);
+			ImGui::RadioButton("fast", &data->giMode, 3);
+			ImGui::SameLine(0);
+			ImGui::InputFloat("fgtTolerance", &data->fgtTolerance, 0, 0, "%.0e");
+			ImGui::SameLine(0);
+			ImGui::RadioButton("monomial", &data->fitBasis, Monomial);
+			ImGui::SameLine(0);
+			ImGui::RadioButton("chebyshev", &data->fitBasis, Chebyshev);
+
+			if (tuneLambda || tuneSigma) {
+				AutoTune(data, tuneLambda, tuneSigma);
+			}
+			PlotCurve("lambda GCV", lambdaCurve);
+			if (lambdaCurve.best != -1 && sigmaCurve.best != -1) ImGui::SameLine(0);
+			PlotCurve("sigma LOOCV", sigmaCurve);
+
 			ImVec2 canvasOrigin = ImGui::GetCursorScreenPos();
 			ImVec2 canvasSize = ImGui::GetContentRegionAvail();
 			ImVec2 canvasDiagonal = ImVec2(canvasOrigin.x + canvasSize.x, canvasSize.y + canvasOrigin.y);
@@ -424,6 +555,7 @@ void FittingSystem::OnUpdate(UECS::Schedule& schedule)
 				//const pointf2& mousePosInCanvas = ScreenPos2DomainDefinition(data, ImVec2(io.MousePos.x, io.MousePos.y), canvasOrigin, canvasSize);
 				data->xs.push_back(io.MousePos.x - canvasOrigin.x);
 				data->ys.push_back(canvasDiagonal.y - io.MousePos.y);
+				++data->version;
 			}
 
 			// Add backgroud and border
@@ -441,10 +573,12 @@ void FittingSystem::OnUpdate(UECS::Schedule& schedule)
 				if (ImGui::MenuItem("RemoveAll", NULL, false, data->xs.size() > 0 || data->ys.size() > 0)) {
 					data->xs.clear();
 					data->ys.clear();
+					++data->version;
 				}
 				if (ImGui::MenuItem("RemoveOne", NULL, false, data->xs.size() > 0 || data->ys.size() > 0)) {
 					data->xs.resize(data->xs.size() - 1);
 					data->ys.resize(data->ys.size() - 1);
+					++data->version;
 				}
 				ImGui::EndPopup();
 			}
@@ -461,22 +595,8 @@ void FittingSystem::OnUpdate(UECS::Schedule& schedule)
 			// Add render clip. Ignore which out of scope.
 			drawList->PushClipRect(canvasOrigin, canvasDiagonal, true);
 			// Draw interpolate and fitting line.
-			if (data->xs.size() >= 2 && data->switchs["enableCurve"]) {
-				CurveFit(data, drawList, canvasOrigin, canvasSize);
-			}
-			else if (data->xs.size() >= 2) {
-				if (data->switchs["enablePolynomialInterpolate"]) {
-					_PI(data, canvasOrigin, canvasSize, drawList);
-				}
-				if (data->switchs["enableGaussInterpolate"]) {
-					GI(data, canvasOrigin, canvasSize, drawList, data->sigma);
-				}
-				if (data->switchs["enablePolynomialFit"]) {
-					PF(data, drawList, canvasOrigin, canvasSize);
-				}
-				if (data->switchs["enableRidgeFit"]) {
-					FR(data, drawList, canvasOrigin, canvasSize);
-				}
+			if (data->xs.size() >= 2) {
+				FitAll(data, data->switchs["enableCurve"], drawList, canvasOrigin, canvasSize);
 			}
 			drawList->PopClipRect();
 		}
@@ -3,14 +3,22 @@
 #include <vector>
 #include "UECS/World.h"
 #include "../Components/CanvasData.h"
+#include "../Fitting/FittingKernels.h"
 #include "Eigen/Dense"
 #include <_deps/imgui/imgui.h>
 #include <iostream>
 
-enum ParamMode {
-	Uniform = 1,
-	Chordal, // Radian length
-	Centripetal,  // Sqrt radian length
+// How polynomial interpolation is solved and evaluated
+enum PIMode {
+	Vandermonde = 1,
+	Barycentric, // Second barycentric form, stable for many points
+};
+
+// Which kernel Gauss interpolation uses
+enum GIMode {
+	GaussDense = 1,
+	GaussCompact, // Wendland C2 with support 3 * sigma, sparse solve
+	GaussFast, // Dense solve, fast Gauss transform evaluation
 };
 
 struct FittingSystem
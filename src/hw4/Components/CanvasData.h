@@ -37,15 +37,29 @@ struct CanvasData {
 	bool enableCurve{ false };
 	bool addingPoint{ false };
 	bool isDP1 = false;
+	// Re-solve only the knots around a dragged one, see IncrementalSpline.
+	bool enableIncrementalDrag{ true };
+	// Sample the curve at equal arc length instead of adaptively in t.
+	bool arcLengthSampling{ false };
+	// Draw the smoothing spline of the knots too, see Spline/SmoothingSpline.h.
+	bool enableSmoothing{ false };
 
 	int movePoint{ -1 };
 	int moveDerivative{ -1 };
 	int paramMode{ 0 };
+	// SplineBoundary of the curve: natural, clamped or periodic (closed).
+	int boundaryMode{ 1 };
 
 	float delta{ 1. };
 	float tDelta{ 1. };
 	float tInterval{ 30. };
 	float derivativeMul{ 8. };
+	// Pixels the incremental drag may be off before the release re-solves it.
+	float dragTolerance{ 0.05 };
+	// Pixels between arc length samples.
+	float arcSpacing{ 4. };
+	// Weight of the curvature against the distance to the knots.
+	float smoothLambda{ 1000. };
 
 	// Persistent date use for program logic
 	bool gizmoShowState{ false };
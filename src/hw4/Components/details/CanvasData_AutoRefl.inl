@@ -76,6 +76,15 @@ struct Ubpa::USRefl::TypeInfo<CanvasData> :
         Field {TSTR("isDP1"), &Type::isDP1, AttrList {
             Attr {TSTR(UMeta::initializer), []()->bool{ return false; }},
         }},
+        Field {TSTR("enableIncrementalDrag"), &Type::enableIncrementalDrag, AttrList {
+            Attr {TSTR(UMeta::initializer), []()->bool{ return { true }; }},
+        }},
+        Field {TSTR("arcLengthSampling"), &Type::arcLengthSampling, AttrList {
+            Attr {TSTR(UMeta::initializer), []()->bool{ return { false }; }},
+        }},
+        Field {TSTR("enableSmoothing"), &Type::enableSmoothing, AttrList {
+            Attr {TSTR(UMeta::initializer), []()->bool{ return { false }; }},
+        }},
         Field {TSTR("movePoint"), &Type::movePoint, AttrList {
             Attr {TSTR(UMeta::initializer), []()->int{ return { -1 }; }},
         }},
@@ -85,6 +94,9 @@ struct Ubpa::USRefl::TypeInfo<CanvasData> :
         Field {TSTR("paramMode"), &Type::paramMode, AttrList {
             Attr {TSTR(UMeta::initializer), []()->int{ return { 0 }; }},
         }},
+        Field {TSTR("boundaryMode"), &Type::boundaryMode, AttrList {
+            Attr {TSTR(UMeta::initializer), []()->int{ return { 1 }; }},
+        }},
         Field {TSTR("delta"), &Type::delta, AttrList {
             Attr {TSTR(UMeta::initializer), []()->float{ return { 1. }; }},
         }},
@@ -97,6 +109,15 @@ struct Ubpa::USRefl::TypeInfo<CanvasData> :
         Field {TSTR("derivativeMul"), &Type::derivativeMul, AttrList {
             Attr {TSTR(UMeta::initializer), []()->float{ return { 8. }; }},
         }},
+        Field {TSTR("dragTolerance"), &Type::dragTolerance, AttrList {
+            Attr {TSTR(UMeta::initializer), []()->float{ return { 0.05 }; }},
+        }},
+        Field {TSTR("arcSpacing"), &Type::arcSpacing, AttrList {
+            Attr {TSTR(UMeta::initializer), []()->float{ return { 4. }; }},
+        }},
+        Field {TSTR("smoothLambda"), &Type::smoothLambda, AttrList {
+            Attr {TSTR(UMeta::initializer), []()->float{ return { 1000. }; }},
+        }},
         Field {TSTR("gizmoShowState"), &Type::gizmoShowState, AttrList {
             Attr {TSTR(UMeta::initializer), []()->bool{ return { false }; }},
         }},
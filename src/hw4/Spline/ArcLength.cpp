@@ -0,0 +1,119 @@
+#include "ArcLength.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	// 5 point Gauss-Legendre on [-1, 1], exact for polynomials up to degree 9.
+	constexpr int GAUSS_COUNT = 5;
+	constexpr double GAUSS_NODES[GAUSS_COUNT] = {
+		-0.9061798459386640, -0.5384693101056831, 0., 0.5384693101056831, 0.9061798459386640,
+	};
+	constexpr double GAUSS_WEIGHTS[GAUSS_COUNT] = {
+		0.2369268850561891, 0.4786286704993665, 0.5688888888888889, 0.4786286704993665, 0.2369268850561891,
+	};
+	// Newton steps of the inverse, each one costs a quadrature of the partial span.
+	constexpr int NEWTON_STEPS = 3;
+
+	double Speed(const SplineCoefficients& x, const SplineCoefficients& y, int i, double t) {
+		double dx = x.DerivativePiece(i, static_cast<float>(t));
+		double dy = y.DerivativePiece(i, static_cast<float>(t));
+		return std::sqrt(dx * dx + dy * dy);
+	}
+
+	// Arc length of piece i over [t0, t1]
+	double SpanLength(const SplineCoefficients& x, const SplineCoefficients& y, int i, double t0, double t1) {
+		double half = 0.5 * (t1 - t0);
+		double mid = 0.5 * (t1 + t0);
+		double sum = 0;
+		for (int g = 0; g < GAUSS_COUNT; ++g) {
+			sum += GAUSS_WEIGHTS[g] * Speed(x, y, i, mid + half * GAUSS_NODES[g]);
+		}
+		return sum * half;
+	}
+}
+
+void ArcLengthTable::Integrate(const SplineCoefficients& x, const SplineCoefficients& y, int i) {
+	double t0 = x.Knot(i);
+	double h = (x.Knot(i + 1) - t0) / SUBDIVISIONS;
+	double length = 0;
+	for (int k = 0; k < SUBDIVISIONS; ++k) {
+		length += SpanLength(x, y, i, t0 + k * h, t0 + (k + 1) * h);
+		spans[i * SUBDIVISIONS + k] = static_cast<float>(length);
+	}
+}
+
+void ArcLengthTable::Build(const SplineCoefficients& x, const SplineCoefficients& y) {
+	int pieces = x.PieceCount();
+	starts.assign(pieces + 1, 0.);
+	spans.resize(pieces * SUBDIVISIONS);
+	Update(x, y, 0, pieces - 1);
+}
+
+void ArcLengthTable::Update(const SplineCoefficients& x, const SplineCoefficients& y, int first, int last) {
+	int pieces = PieceCount();
+	first = std::max(first, 0);
+	last = std::min(last, pieces - 1);
+	for (int i = first; i <= last; ++i) {
+		Integrate(x, y, i);
+	}
+	for (int i = first; i < pieces; ++i) {
+		starts[i + 1] = starts[i] + spans[i * SUBDIVISIONS + SUBDIVISIONS - 1];
+	}
+}
+
+// t on piece i whose arc length from the piece start is local.
+float ArcLengthTable::LocalParam(const SplineCoefficients& x, const SplineCoefficients& y, int i, double local) const {
+	const float* span = spans.data() + i * SUBDIVISIONS;
+	int k = static_cast<int>(std::upper_bound(span, span + SUBDIVISIONS - 1, static_cast<float>(local)) - span);
+	double spanStart = k > 0 ? span[k - 1] : 0.;
+	double spanLength = span[k] - spanStart;
+	double t0 = x.Knot(i);
+	double h = (x.Knot(i + 1) - t0) / SUBDIVISIONS;
+	double ta = t0 + k * h;
+	double tb = ta + h;
+
+	// Linear guess inside the span, then Newton on L(t) = local, kept in the span.
+	double target = local - spanStart;
+	double t = spanLength > 0 ? ta + h * std::clamp(target / spanLength, 0., 1.) : ta;
+	for (int step = 0; step < NEWTON_STEPS; ++step) {
+		double speed = Speed(x, y, i, t);
+		if (!(speed > 0)) break;
+		double error = SpanLength(x, y, i, ta, t) - target;
+		t = std::clamp(t - error / speed, ta, tb);
+	}
+	return static_cast<float>(t);
+}
+
+float ArcLengthTable::ParamAt(const SplineCoefficients& x, const SplineCoefficients& y, double s, int* piece) const {
+	int pieces = PieceCount();
+	if (pieces <= 0) {
+		if (piece) *piece = 0;
+		return 0.f;
+	}
+	s = std::clamp(s, 0., Length());
+	int i = static_cast<int>(std::upper_bound(starts.begin() + 1, starts.end() - 1, s) - starts.begin()) - 1;
+	if (piece) *piece = i;
+	return LocalParam(x, y, i, s - starts[i]);
+}
+
+void ArcLengthTable::EqualSpaced(const SplineCoefficients& x, const SplineCoefficients& y, float spacing,
+	std::vector<float>& ts, std::vector<int>& pieces) const {
+	ts.clear();
+	pieces.clear();
+	int pieceCount = PieceCount();
+	if (pieceCount <= 0 || !(spacing > 0)) return;
+
+	double length = Length();
+	int count = static_cast<int>(std::ceil(length / spacing)) + 1;
+	double step = count > 1 ? length / (count - 1) : 0.;
+	ts.resize(count);
+	pieces.resize(count);
+	int i = 0;
+	for (int k = 0; k < count; ++k) {
+		double s = k == count - 1 ? length : k * step;
+		while (i < pieceCount - 1 && s >= starts[i + 1]) ++i;
+		ts[k] = LocalParam(x, y, i, s - starts[i]);
+		pieces[k] = i;
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+// Arc length of a planar spline given by its x and y SplineCoefficients, for
+// sampling at constant speed instead of constant dt. Every piece is split in
+// SUBDIVISIONS spans integrated with 5 point Gauss-Legendre quadrature; the
+// pieces are chained with prefix sums in double. The inverse s -> t is a binary
+// search over the pieces and their spans followed by a few Newton steps.
+
+#include <vector>
+#include "SplineEval.h"
+
+class ArcLengthTable {
+public:
+	// Spans per piece.
+	static constexpr int SUBDIVISIONS = 4;
+
+	void Build(const SplineCoefficients& x, const SplineCoefficients& y);
+	// Integrate pieces [first, last] again, the piece count is unchanged. Only the
+	// prefix sums after first are redone for the other pieces.
+	void Update(const SplineCoefficients& x, const SplineCoefficients& y, int first, int last);
+
+	int PieceCount() const { return static_cast<int>(starts.size()) - 1; }
+	double Length() const { return starts.empty() ? 0. : starts.back(); }
+	// Arc length from the start of the curve to the start of piece i.
+	double Start(int i) const { return starts[i]; }
+
+	// t at arc length s, clamped to [0, Length()]. O(log n). piece gets the
+	// piece of t if not null.
+	float ParamAt(const SplineCoefficients& x, const SplineCoefficients& y, double s, int* piece = nullptr) const;
+	// The fewest points no farther than spacing apart along the curve, equally
+	// spaced, first and last at the ends: ts[k] with pieces[k] holding it.
+	// Samples are walked forward, O(n + samples).
+	void EqualSpaced(const SplineCoefficients& x, const SplineCoefficients& y, float spacing,
+		std::vector<float>& ts, std::vector<int>& pieces) const;
+
+private:
+	void Integrate(const SplineCoefficients& x, const SplineCoefficients& y, int i);
+	float LocalParam(const SplineCoefficients& x, const SplineCoefficients& y, int i, double local) const;
+
+	// PieceCount() + 1 prefix sums, starts[0] = 0
+	std::vector<double> starts;
+	// SUBDIVISIONS per piece, length from the piece start to the end of each span
+	std::vector<float> spans;
+};
@@ -0,0 +1,84 @@
+#include "SmoothingSpline.h"
+
+#include <algorithm>
+#include <vector>
+
+void SmoothingSpline(const float* ts, const float* const* columns, int dim, int count, float lambda,
+	float* const* values, float* const* moments) {
+	if (count <= 0) return;
+	for (int d = 0; d < dim; ++d) {
+		std::copy(columns[d], columns[d] + count, values[d]);
+		std::fill(moments[d], moments[d] + count, 0.f);
+	}
+	// Two knots are a line already.
+	int m = count - 2;
+	if (m <= 0) return;
+
+	std::vector<double> invH(count - 1);
+	for (int i = 0; i < count - 1; ++i) {
+		invH[i] = 1. / (double(ts[i + 1]) - ts[i]);
+	}
+	// Row k is interior knot i = k + 1. diag, first and second super diagonal of
+	// R + lambda * Q^T Q; Q's column k is (1 / h_i-1, -1 / h_i-1 - 1 / h_i, 1 / h_i)
+	// at knots i - 1, i, i + 1.
+	std::vector<double> diag(m);
+	std::vector<double> first(m, 0.);
+	std::vector<double> second(m, 0.);
+	for (int k = 0; k < m; ++k) {
+		int i = k + 1;
+		double hc = double(ts[i]) - ts[i - 1];
+		double hn = double(ts[i + 1]) - ts[i];
+		double q = invH[i - 1] + invH[i];
+		diag[k] = (hc + hn) / 3. + lambda * (invH[i - 1] * invH[i - 1] + q * q + invH[i] * invH[i]);
+		if (k + 1 < m) {
+			double qn = invH[i] + invH[i + 1];
+			first[k] = hn / 6. - lambda * invH[i] * (q + qn);
+		}
+		if (k + 2 < m) {
+			second[k] = lambda * invH[i] * invH[i + 1];
+		}
+	}
+
+	// LDL^T in place: diag becomes D, first and second the two sub diagonals of L.
+	for (int k = 0; k < m; ++k) {
+		double a1 = k >= 1 ? first[k - 1] : 0.;
+		double d1 = k >= 1 ? diag[k - 1] : 0.;
+		double b2 = k >= 2 ? second[k - 2] : 0.;
+		double d2 = k >= 2 ? diag[k - 2] : 0.;
+		double b1 = k >= 1 ? second[k - 1] : 0.;
+		diag[k] -= d1 * a1 * a1 + d2 * b2 * b2;
+		if (k + 1 < m) first[k] = (first[k] - d1 * a1 * b1) / diag[k];
+		if (k + 2 < m) second[k] /= diag[k];
+	}
+
+	std::vector<double> gamma(m);
+	for (int d = 0; d < dim; ++d) {
+		const float* y = columns[d];
+		// Q^T y = d_i - d_i-1 with the chord slopes d_i.
+		for (int k = 0; k < m; ++k) {
+			int i = k + 1;
+			gamma[k] = (double(y[i + 1]) - y[i]) * invH[i] - (double(y[i]) - y[i - 1]) * invH[i - 1];
+		}
+		for (int k = 0; k < m; ++k) {
+			if (k >= 1) gamma[k] -= first[k - 1] * gamma[k - 1];
+			if (k >= 2) gamma[k] -= second[k - 2] * gamma[k - 2];
+		}
+		for (int k = m - 1; k >= 0; --k) {
+			gamma[k] /= diag[k];
+			if (k + 1 < m) gamma[k] -= first[k] * gamma[k + 1];
+			if (k + 2 < m) gamma[k] -= second[k] * gamma[k + 2];
+		}
+
+		// g_j = y_j - lambda * (Q gamma)_j, gamma is 0 at both ends.
+		auto moment = [&](int i) { return i >= 1 && i <= m ? gamma[i - 1] : 0.; };
+		for (int j = 0; j < count; ++j) {
+			double qGamma = 0;
+			if (j + 1 < count) qGamma += (moment(j + 1) - moment(j)) * invH[j];
+			if (j >= 1) qGamma -= (moment(j) - moment(j - 1)) * invH[j - 1];
+			values[d][j] = static_cast<float>(y[j] - lambda * qGamma);
+		}
+		for (int k = 0; k < m; ++k) {
+			moments[d][k + 1] = static_cast<float>(gamma[k]);
+		}
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+// Cubic smoothing spline of noisy knots (Reinsch). g minimizes
+//   sum (y_i - g(t_i))^2 + lambda * integral g''(t)^2 dt,
+// lambda = 0 interpolates, lambda -> infinity tends to the least squares line.
+// With Q the (n x n-2) second difference matrix and R the (n-2 x n-2) moment
+// matrix of the natural spline, the interior moments solve
+//   (R + lambda * Q^T Q) * gamma = Q^T * y,   g = y - lambda * Q * gamma.
+// The matrix is symmetric positive definite and pentadiagonal, a banded LDL^T
+// solves it in O(n) time and memory. g with the moments gamma is a natural
+// spline, draw it like any other (SplineCoefficients::Build).
+
+// values[d] gets g(t_i), moments[d] gets g''(t_i) with 0 at both ends.
+// columns[d] share the knots ts (x and y of a curve), they share one factorization.
+void SmoothingSpline(const float* ts, const float* const* columns, int dim, int count, float lambda,
+	float* const* values, float* const* moments);
+inline void SmoothingSpline(const float* ts, const float* ys, int count, float lambda, float* values, float* moments) {
+	SmoothingSpline(ts, &ys, 1, count, lambda, &values, &moments);
+}
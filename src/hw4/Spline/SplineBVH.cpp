@@ -0,0 +1,226 @@
+#include "SplineBVH.h"
+
+#include <algorithm>
+
+namespace {
+	// Start points of the Newton iteration inside a piece, and the
+	// subintervals a ray crossing is bracketed in.
+	constexpr int SAMPLES = 8;
+	constexpr int NEWTON_STEPS = 4;
+	constexpr int BISECTION_STEPS = 24;
+	constexpr int STACK_DEPTH = 64;
+
+	// Distance from (px, py) to the box, squared; 0 inside.
+	template<typename Box>
+	float BoxDistance2(const Box& box, float px, float py) {
+		float dx = std::max(std::max(box.minX - px, px - box.maxX), 0.f);
+		float dy = std::max(std::max(box.minY - py, py - box.maxY), 0.f);
+		return dx * dx + dy * dy;
+	}
+
+	// Entry parameter of the ray into the box, INFINITY if it misses.
+	template<typename Box>
+	float BoxEntry(const Box& box, float ox, float oy, float dx, float dy) {
+		float enter = 0.f;
+		float exit = INFINITY;
+		auto slab = [&](float o, float d, float lo, float hi) {
+			if (d == 0.f) {
+				if (o < lo || o > hi) exit = -INFINITY;
+				return;
+			}
+			float s0 = (lo - o) / d;
+			float s1 = (hi - o) / d;
+			enter = std::max(enter, std::min(s0, s1));
+			exit = std::min(exit, std::max(s0, s1));
+		};
+		// Empty leaves past the last piece have lo > hi and miss.
+		if (box.minX > box.maxX) return INFINITY;
+		slab(ox, dx, box.minX, box.maxX);
+		slab(oy, dy, box.minY, box.maxY);
+		return enter <= exit ? enter : INFINITY;
+	}
+
+	// Closest point of piece i to (px, py), starting Newton from the best sample.
+	void NearestOnPiece(const SplineCoefficients& x, const SplineCoefficients& y, int i,
+		float px, float py, CurveHit& best) {
+		float t0 = x.Knot(i);
+		float t1 = x.Knot(i + 1);
+		float sample = t0;
+		float sample2 = INFINITY;
+		for (int k = 0; k <= SAMPLES; ++k) {
+			float s = t0 + (t1 - t0) * k / SAMPLES;
+			float ex = x.EvalPiece(i, s) - px;
+			float ey = y.EvalPiece(i, s) - py;
+			if (ex * ex + ey * ey < sample2) {
+				sample2 = ex * ex + ey * ey;
+				sample = s;
+			}
+		}
+		// Root of g(t) = (P(t) - p) . P'(t).
+		float t = sample;
+		for (int step = 0; step < NEWTON_STEPS; ++step) {
+			float ex = x.EvalPiece(i, t) - px;
+			float ey = y.EvalPiece(i, t) - py;
+			float dx = x.DerivativePiece(i, t);
+			float dy = y.DerivativePiece(i, t);
+			float g = ex * dx + ey * dy;
+			float dg = dx * dx + dy * dy + ex * x.SecondDerivativePiece(i, t) + ey * y.SecondDerivativePiece(i, t);
+			if (dg <= 0.f) break;
+			t = std::clamp(t - g / dg, t0, t1);
+		}
+		float cx = x.EvalPiece(i, t);
+		float cy = y.EvalPiece(i, t);
+		float d2 = (cx - px) * (cx - px) + (cy - py) * (cy - py);
+		// Newton can wander off to a worse stationary point, keep the sample then.
+		if (d2 > sample2) {
+			t = sample;
+			cx = x.EvalPiece(i, t);
+			cy = y.EvalPiece(i, t);
+			d2 = sample2;
+		}
+		float distance = std::sqrt(d2);
+		if (distance < best.distance) {
+			best = { i, t, cx, cy, distance };
+		}
+	}
+
+	// Crossings of piece i with the ray's line, bracketed by sign changes of
+	// the signed distance n . (P(t) - o) and bisected.
+	void RaycastPiece(const SplineCoefficients& x, const SplineCoefficients& y, int i,
+		float ox, float oy, float dx, float dy, CurveHit& best) {
+		float t0 = x.Knot(i);
+		float t1 = x.Knot(i + 1);
+		auto side = [&](float t) { return (x.EvalPiece(i, t) - ox) * dy - (y.EvalPiece(i, t) - oy) * dx; };
+		float invLength2 = 1.f / (dx * dx + dy * dy);
+		float lo = t0;
+		float fLo = side(lo);
+		for (int k = 1; k <= SAMPLES; ++k) {
+			float hi = k == SAMPLES ? t1 : t0 + (t1 - t0) * k / SAMPLES;
+			float fHi = side(hi);
+			if ((fLo <= 0.f) != (fHi <= 0.f) || fHi == 0.f) {
+				float a = lo, b = hi, fa = fLo;
+				for (int step = 0; step < BISECTION_STEPS; ++step) {
+					float mid = 0.5f * (a + b);
+					float fMid = side(mid);
+					if ((fa <= 0.f) == (fMid <= 0.f)) {
+						a = mid;
+						fa = fMid;
+					}
+					else b = mid;
+				}
+				float t = 0.5f * (a + b);
+				float cx = x.EvalPiece(i, t);
+				float cy = y.EvalPiece(i, t);
+				float s = ((cx - ox) * dx + (cy - oy) * dy) * invLength2;
+				if (s >= 0.f && s < best.distance) {
+					best = { i, t, cx, cy, s };
+				}
+			}
+			lo = hi;
+			fLo = fHi;
+		}
+	}
+}
+
+void SplineBVH::Build(const SplineCoefficients& x, const SplineCoefficients& y) {
+	pieceCount = x.PieceCount();
+	leafStart = 1;
+	while (leafStart < pieceCount) leafStart *= 2;
+	nodes.assign(2 * leafStart, Box{});
+	for (int i = 0; i < pieceCount; ++i) {
+		Fit(x, y, i);
+	}
+	for (int node = leafStart - 1; node >= 1; --node) {
+		Merge(node);
+	}
+}
+
+void SplineBVH::Refit(const SplineCoefficients& x, const SplineCoefficients& y, int first, int last) {
+	if (x.PieceCount() != pieceCount) {
+		Build(x, y);
+		return;
+	}
+	first = std::max(first, 0);
+	last = std::min(last, pieceCount - 1);
+	if (first > last) return;
+	for (int i = first; i <= last; ++i) {
+		Fit(x, y, i);
+	}
+	// The changed leaves are a contiguous range, so are their ancestors per level.
+	for (int lo = (leafStart + first) / 2, hi = (leafStart + last) / 2; lo >= 1; lo /= 2, hi /= 2) {
+		for (int node = lo; node <= hi; ++node) {
+			Merge(node);
+		}
+	}
+}
+
+void SplineBVH::Fit(const SplineCoefficients& x, const SplineCoefficients& y, int i) {
+	// Bezier control points of the piece: P1 = P0 + P'(t0) h / 3, P2 = P3 - P'(t1) h / 3.
+	float t0 = x.Knot(i);
+	float t1 = x.Knot(i + 1);
+	float third = (t1 - t0) / 3.f;
+	float x0 = x.EvalPiece(i, t0);
+	float y0 = y.EvalPiece(i, t0);
+	float x3 = x.EvalPiece(i, t1);
+	float y3 = y.EvalPiece(i, t1);
+	float xs[4] = { x0, x0 + x.DerivativePiece(i, t0) * third, x3 - x.DerivativePiece(i, t1) * third, x3 };
+	float ys[4] = { y0, y0 + y.DerivativePiece(i, t0) * third, y3 - y.DerivativePiece(i, t1) * third, y3 };
+	Box& box = nodes[leafStart + i];
+	box.minX = *std::min_element(xs, xs + 4);
+	box.maxX = *std::max_element(xs, xs + 4);
+	box.minY = *std::min_element(ys, ys + 4);
+	box.maxY = *std::max_element(ys, ys + 4);
+}
+
+void SplineBVH::Merge(int node) {
+	const Box& l = nodes[2 * node];
+	const Box& r = nodes[2 * node + 1];
+	nodes[node] = { std::min(l.minX, r.minX), std::min(l.minY, r.minY), std::max(l.maxX, r.maxX), std::max(l.maxY, r.maxY) };
+}
+
+CurveHit SplineBVH::Nearest(const SplineCoefficients& x, const SplineCoefficients& y, float px, float py, float maxDistance) const {
+	CurveHit best;
+	best.distance = maxDistance;
+	if (pieceCount <= 0) return best;
+	int stack[STACK_DEPTH];
+	int top = 0;
+	stack[top++] = 1;
+	while (top > 0) {
+		int node = stack[--top];
+		if (BoxDistance2(nodes[node], px, py) >= best.distance * best.distance) continue;
+		if (node >= leafStart) {
+			NearestOnPiece(x, y, node - leafStart, px, py, best);
+			continue;
+		}
+		// Push the farther child first so the nearer one shrinks the bound early.
+		int l = 2 * node;
+		int r = l + 1;
+		if (BoxDistance2(nodes[l], px, py) < BoxDistance2(nodes[r], px, py)) std::swap(l, r);
+		stack[top++] = l;
+		stack[top++] = r;
+	}
+	if (best.piece < 0) best.distance = INFINITY;
+	return best;
+}
+
+CurveHit SplineBVH::Raycast(const SplineCoefficients& x, const SplineCoefficients& y, float ox, float oy, float dx, float dy) const {
+	CurveHit best;
+	if (pieceCount <= 0 || (dx == 0.f && dy == 0.f)) return best;
+	int stack[STACK_DEPTH];
+	int top = 0;
+	stack[top++] = 1;
+	while (top > 0) {
+		int node = stack[--top];
+		if (BoxEntry(nodes[node], ox, oy, dx, dy) >= best.distance) continue;
+		if (node >= leafStart) {
+			RaycastPiece(x, y, node - leafStart, ox, oy, dx, dy, best);
+			continue;
+		}
+		int l = 2 * node;
+		int r = l + 1;
+		if (BoxEntry(nodes[l], ox, oy, dx, dy) < BoxEntry(nodes[r], ox, oy, dx, dy)) std::swap(l, r);
+		stack[top++] = l;
+		stack[top++] = r;
+	}
+	return best;
+}
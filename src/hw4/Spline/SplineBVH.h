@@ -0,0 +1,54 @@
+#pragma once
+
+// Nearest point and ray queries on a planar spline given by its x and y
+// SplineCoefficients. Every piece is bounded by the box of its Bezier control
+// polygon, which holds the convex hull and so the piece. The pieces follow
+// the curve, neighbours are neighbours in space too, so a complete binary tree
+// over them in order is the hierarchy: no sorting to build, and a dragged knot
+// refits its pieces and their O(log n) ancestors. Inside a piece the answer is
+// refined with Newton steps on the cubic.
+
+#include <cmath>
+#include <vector>
+#include "SplineEval.h"
+
+struct CurveHit {
+	// -1 when nothing was found.
+	int piece{ -1 };
+	float t{ 0 };
+	float x{ 0 };
+	float y{ 0 };
+	// Distance to the query point, or the ray parameter of a hit.
+	float distance{ INFINITY };
+};
+
+class SplineBVH {
+public:
+	void Build(const SplineCoefficients& x, const SplineCoefficients& y);
+	// Pieces [first, last] changed shape, the piece count is unchanged.
+	void Refit(const SplineCoefficients& x, const SplineCoefficients& y, int first, int last);
+
+	int PieceCount() const { return pieceCount; }
+
+	// Closest point of the curve to (px, py) within maxDistance.
+	CurveHit Nearest(const SplineCoefficients& x, const SplineCoefficients& y, float px, float py, float maxDistance = INFINITY) const;
+	// First crossing of the ray (ox, oy) + s * (dx, dy), s >= 0; distance gets s.
+	CurveHit Raycast(const SplineCoefficients& x, const SplineCoefficients& y, float ox, float oy, float dx, float dy) const;
+
+private:
+	struct Box {
+		float minX{ INFINITY };
+		float minY{ INFINITY };
+		float maxX{ -INFINITY };
+		float maxY{ -INFINITY };
+	};
+
+	void Fit(const SplineCoefficients& x, const SplineCoefficients& y, int i);
+	void Merge(int node);
+
+	int pieceCount{ 0 };
+	// Leaves start here, a power of two.
+	int leafStart{ 1 };
+	// nodes[1] is the root, nodes[k] has children 2k and 2k + 1.
+	std::vector<Box> nodes;
+};
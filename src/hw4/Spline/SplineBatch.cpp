@@ -0,0 +1,182 @@
+#include "SplineBatch.h"
+
+#include <algorithm>
+#include <vector>
+#include "../../Common/TaskPool.h"
+
+#if !defined(FITTING_NO_SIMD) && defined(__AVX2__)
+#define SPLINE_AVX2
+#include <immintrin.h>
+#elif !defined(FITTING_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define SPLINE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+	// One value per curve of a group, the operations the solver needs.
+#if defined(SPLINE_AVX2)
+	constexpr int LANE = 8;
+	using Pack = __m256;
+	inline Pack Load(const float* p) { return _mm256_loadu_ps(p); }
+	inline void Store(float* p, Pack v) { _mm256_storeu_ps(p, v); }
+	inline Pack Set1(float v) { return _mm256_set1_ps(v); }
+	inline Pack Add(Pack a, Pack b) { return _mm256_add_ps(a, b); }
+	inline Pack Sub(Pack a, Pack b) { return _mm256_sub_ps(a, b); }
+	inline Pack Mul(Pack a, Pack b) { return _mm256_mul_ps(a, b); }
+	inline Pack Div(Pack a, Pack b) { return _mm256_div_ps(a, b); }
+	// yes in the lanes where a < b, no elsewhere
+	inline Pack SelectLess(Pack a, Pack b, Pack yes, Pack no) { return _mm256_blendv_ps(no, yes, _mm256_cmp_ps(a, b, _CMP_LT_OQ)); }
+#elif defined(SPLINE_NEON)
+	constexpr int LANE = 4;
+	using Pack = float32x4_t;
+	inline Pack Load(const float* p) { return vld1q_f32(p); }
+	inline void Store(float* p, Pack v) { vst1q_f32(p, v); }
+	inline Pack Set1(float v) { return vdupq_n_f32(v); }
+	inline Pack Add(Pack a, Pack b) { return vaddq_f32(a, b); }
+	inline Pack Sub(Pack a, Pack b) { return vsubq_f32(a, b); }
+	inline Pack Mul(Pack a, Pack b) { return vmulq_f32(a, b); }
+#if defined(__aarch64__)
+	inline Pack Div(Pack a, Pack b) { return vdivq_f32(a, b); }
+#else
+	inline Pack Div(Pack a, Pack b) {
+		// Two Newton steps on the reciprocal estimate.
+		Pack inv = vrecpeq_f32(b);
+		inv = vmulq_f32(vrecpsq_f32(b, inv), inv);
+		inv = vmulq_f32(vrecpsq_f32(b, inv), inv);
+		return vmulq_f32(a, inv);
+	}
+#endif
+	inline Pack SelectLess(Pack a, Pack b, Pack yes, Pack no) { return vbslq_f32(vcltq_f32(a, b), yes, no); }
+#else
+	constexpr int LANE = 1;
+	using Pack = float;
+	inline Pack Load(const float* p) { return *p; }
+	inline void Store(float* p, Pack v) { *p = v; }
+	inline Pack Set1(float v) { return v; }
+	inline Pack Add(Pack a, Pack b) { return a + b; }
+	inline Pack Sub(Pack a, Pack b) { return a - b; }
+	inline Pack Mul(Pack a, Pack b) { return a * b; }
+	inline Pack Div(Pack a, Pack b) { return a / b; }
+	inline Pack SelectLess(Pack a, Pack b, Pack yes, Pack no) { return a < b ? yes : no; }
+#endif
+
+	// Groups a task solves, so the pool hands out enough work per index.
+	constexpr int GROUPS_PER_TASK = 16;
+
+	// Interleaved knots of one group, [i * LANE + lane].
+	struct GroupScratch {
+		std::vector<float> ts;
+		std::vector<float> ys;
+		std::vector<float> upper;
+		std::vector<float> forward;
+		float lastRows[LANE];
+	};
+
+	void SolveGroup(const float* ts, const float* ys, const int* counts, int stride, int curveCount, float* moments,
+		int firstCurve, GroupScratch& scratch) {
+		int lanes = std::min(LANE, curveCount - firstCurve);
+		int maxCount = 0;
+		for (int l = 0; l < lanes; ++l) {
+			maxCount = std::max(maxCount, counts ? counts[firstCurve + l] : stride);
+		}
+		if (maxCount < 3) {
+			for (int l = 0; l < lanes; ++l) {
+				int c = firstCurve + l;
+				std::fill(moments + c * stride, moments + c * stride + (counts ? counts[c] : stride), 0.f);
+			}
+			return;
+		}
+
+		// Gather. Knots past a curve's end continue with unit steps and a constant
+		// value, so every lane computes finite rows before they are masked out.
+		scratch.ts.resize(maxCount * LANE);
+		scratch.ys.resize(maxCount * LANE);
+		scratch.upper.resize(maxCount * LANE);
+		scratch.forward.resize(maxCount * LANE);
+		float* t = scratch.ts.data();
+		float* y = scratch.ys.data();
+		for (int l = 0; l < LANE; ++l) {
+			int c = firstCurve + l;
+			int count = l < lanes ? (counts ? counts[c] : stride) : 0;
+			const float* ct = ts + (l < lanes ? c * stride : 0);
+			const float* cy = ys + (l < lanes ? c * stride : 0);
+			for (int i = 0; i < count; ++i) {
+				t[i * LANE + l] = ct[i];
+				y[i * LANE + l] = cy[i];
+			}
+			float lastT = count > 0 ? ct[count - 1] : 0.f;
+			float lastY = count > 0 ? cy[count - 1] : 0.f;
+			for (int i = count; i < maxCount; ++i) {
+				t[i * LANE + l] = lastT + (i - count + 1);
+				y[i * LANE + l] = lastY;
+			}
+			// Rows i < count - 1 are interior knots.
+			scratch.lastRows[l] = static_cast<float>(count - 1);
+		}
+
+		// Forward elimination, row i of the interior knots 1..maxCount-2.
+		Pack lastRows = Load(scratch.lastRows);
+		Pack zero = Set1(0.f);
+		Pack one = Set1(1.f);
+		Pack two = Set1(2.f);
+		Pack six = Set1(6.f);
+		Pack prevUpper = zero;
+		Pack prevForward = zero;
+		float* upper = scratch.upper.data();
+		float* forward = scratch.forward.data();
+		// Step and slope of the piece before knot i, carried from the last row.
+		Pack hc = Sub(Load(t + LANE), Load(t));
+		Pack dc = Div(Sub(Load(y + LANE), Load(y)), hc);
+		for (int i = 1; i < maxCount - 1; ++i) {
+			Pack tc = Load(t + i * LANE);
+			Pack hn = Sub(Load(t + (i + 1) * LANE), tc);
+			Pack dn = Div(Sub(Load(y + (i + 1) * LANE), Load(y + i * LANE)), hn);
+			Pack row = Set1(static_cast<float>(i));
+			// Identity rows past a curve's end keep its moments at 0.
+			Pack a = SelectLess(row, lastRows, i > 1 ? hc : zero, zero);
+			Pack b = SelectLess(row, lastRows, Mul(two, Add(hc, hn)), one);
+			Pack c = SelectLess(row, lastRows, hn, zero);
+			Pack r = SelectLess(row, lastRows, Mul(six, Sub(dn, dc)), zero);
+			Pack inv = Div(one, Sub(b, Mul(a, prevUpper)));
+			prevUpper = Mul(c, inv);
+			prevForward = Mul(Sub(r, Mul(a, prevForward)), inv);
+			Store(upper + i * LANE, prevUpper);
+			Store(forward + i * LANE, prevForward);
+			hc = hn;
+			dc = dn;
+		}
+
+		// Back substitution in place of forward, M_0 = M_n-1 = 0.
+		Pack next = zero;
+		for (int i = maxCount - 2; i >= 1; --i) {
+			next = Sub(Load(forward + i * LANE), Mul(Load(upper + i * LANE), next));
+			Store(forward + i * LANE, next);
+		}
+
+		// Scatter.
+		for (int l = 0; l < lanes; ++l) {
+			int c = firstCurve + l;
+			int count = counts ? counts[c] : stride;
+			float* m = moments + c * stride;
+			if (count <= 0) continue;
+			m[0] = 0.f;
+			for (int i = 1; i < count - 1; ++i) {
+				m[i] = forward[i * LANE + l];
+			}
+			if (count > 1) m[count - 1] = 0.f;
+		}
+	}
+}
+
+void SplineMomentsBatch(const float* ts, const float* ys, const int* counts, int stride, int curveCount, float* moments) {
+	if (curveCount <= 0) return;
+	int groups = (curveCount + LANE - 1) / LANE;
+	int tasks = (groups + GROUPS_PER_TASK - 1) / GROUPS_PER_TASK;
+	TaskPool::Instance().ParallelFor(tasks, [&](int task) {
+		GroupScratch scratch;
+		int end = std::min((task + 1) * GROUPS_PER_TASK, groups);
+		for (int g = task * GROUPS_PER_TASK; g < end; ++g) {
+			SolveGroup(ts, ys, counts, stride, curveCount, moments, g * LANE, scratch);
+		}
+	});
+}
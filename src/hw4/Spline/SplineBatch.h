@@ -0,0 +1,14 @@
+#pragma once
+
+// Natural spline moments of many independent curves at once, e.g. thousands
+// of short tracks. Curves are taken LANE at a time (8 with AVX2, 4 with NEON,
+// 1 otherwise) and interleaved, so knot i of every curve of a group is one
+// SIMD register and the Thomas algorithm runs once per group for all of them.
+// Groups are spread over the TaskPool. Unlike SplineMoments the elimination is
+// in float. Define FITTING_NO_SIMD to force the scalar path.
+
+// Curve c has counts[c] knots (stride each if counts is nullptr) at
+// ts[c * stride + i] with values ys[c * stride + i], i < counts[c]; moments
+// is laid out the same way. Shorter curves of a group are padded with
+// identity rows, their moments past counts[c] are left untouched.
+void SplineMomentsBatch(const float* ts, const float* ys, const int* counts, int stride, int curveCount, float* moments);
@@ -0,0 +1,197 @@
+#include "SplineEval.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if !defined(FITTING_NO_SIMD) && defined(__AVX2__)
+#define SPLINE_AVX2
+#include <immintrin.h>
+#elif !defined(FITTING_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define SPLINE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+	inline float Cubic(float a, float b, float c, float d, float u) {
+		return a + u * (b + u * (c + u * d));
+	}
+
+#if defined(SPLINE_AVX2)
+	constexpr int LANE = 8;
+
+	inline __m256 MulAdd(__m256 x, __m256 y, __m256 z) {
+#if defined(__FMA__) || defined(_MSC_VER)
+		return _mm256_fmadd_ps(x, y, z);
+#else
+		return _mm256_add_ps(_mm256_mul_ps(x, y), z);
+#endif
+	}
+
+	inline __m256 Cubic(float a, float b, float c, float d, __m256 u) {
+		__m256 y = MulAdd(_mm256_set1_ps(d), u, _mm256_set1_ps(c));
+		y = MulAdd(y, u, _mm256_set1_ps(b));
+		return MulAdd(y, u, _mm256_set1_ps(a));
+	}
+#elif defined(SPLINE_NEON)
+	constexpr int LANE = 4;
+
+	inline float32x4_t MulAdd(float32x4_t x, float32x4_t y, float32x4_t z) {
+#if defined(__aarch64__)
+		return vfmaq_f32(z, x, y);
+#else
+		return vmlaq_f32(z, x, y);
+#endif
+	}
+
+	inline float32x4_t Cubic(float a, float b, float c, float d, float32x4_t u) {
+		float32x4_t y = MulAdd(vdupq_n_f32(d), u, vdupq_n_f32(c));
+		y = MulAdd(y, u, vdupq_n_f32(b));
+		return MulAdd(y, u, vdupq_n_f32(a));
+	}
+#else
+	constexpr int LANE = 1;
+#endif
+}
+
+void SplineCoefficients::Resize(int count) {
+	int pieces = std::max(count - 1, 0);
+	knots.resize(count);
+	a.resize(pieces);
+	b.resize(pieces);
+	c.resize(pieces);
+	d.resize(pieces);
+}
+
+void SplineCoefficients::SetPiece(int i, float t0, float t1, float y0, float y1, float m0, float m1) {
+	float h = t1 - t0;
+	float invH = 1.f / h;
+	knots[i] = t0;
+	knots[i + 1] = t1;
+	a[i] = y0;
+	b[i] = (y1 - y0) * invH - h * (2.f * m0 + m1) * (1.f / 6);
+	c[i] = 0.5f * m0;
+	d[i] = (m1 - m0) * invH * (1.f / 6);
+}
+
+void SplineCoefficients::SetKnots(const float* ts, int count) {
+	std::copy(ts, ts + std::min(count, static_cast<int>(knots.size())), knots.begin());
+}
+
+void SplineCoefficients::Build(const float* ts, const float* ys, const float* moments, int count) {
+	Resize(count);
+	if (count == 1) knots[0] = ts[0];
+	for (int i = 0; i + 1 < count; ++i) {
+		SetPiece(i, ts[i], ts[i + 1], ys[i], ys[i + 1], moments[i], moments[i + 1]);
+	}
+}
+
+int SplineCoefficients::Find(float t) const {
+	int pieces = PieceCount();
+	if (pieces <= 1) return 0;
+	// Last knot <= t among the inner knots.
+	auto it = std::upper_bound(knots.begin() + 1, knots.begin() + pieces, t);
+	return static_cast<int>(it - knots.begin()) - 1;
+}
+
+int SplineCoefficients::Find(float t, int& cursor) const {
+	int pieces = PieceCount();
+	auto holds = [&](int p) {
+		return (p == 0 || t >= knots[p]) && (p == pieces - 1 || t < knots[p + 1]);
+	};
+	int i = std::clamp(cursor, 0, std::max(pieces - 1, 0));
+	// The piece itself or a neighbour, otherwise search.
+	if (pieces > 1 && !holds(i)) {
+		if (i + 1 < pieces && holds(i + 1)) ++i;
+		else if (i > 0 && holds(i - 1)) --i;
+		else i = Find(t);
+	}
+	cursor = i;
+	return i;
+}
+
+float SplineCoefficients::EvalPiece(int i, float t) const {
+	return Cubic(a[i], b[i], c[i], d[i], t - knots[i]);
+}
+
+float SplineCoefficients::DerivativePiece(int i, float t) const {
+	float u = t - knots[i];
+	return b[i] + u * (2.f * c[i] + u * 3.f * d[i]);
+}
+
+float SplineCoefficients::SecondDerivativePiece(int i, float t) const {
+	return 2.f * c[i] + 6.f * d[i] * (t - knots[i]);
+}
+
+void SplineCoefficients::EvalPiece(int i, const float* ts, float* out, int count) const {
+	float t0 = knots[i];
+	int k = 0;
+#if defined(SPLINE_AVX2)
+	__m256 origin = _mm256_set1_ps(t0);
+	for (; k + LANE <= count; k += LANE) {
+		__m256 u = _mm256_sub_ps(_mm256_loadu_ps(ts + k), origin);
+		_mm256_storeu_ps(out + k, Cubic(a[i], b[i], c[i], d[i], u));
+	}
+#elif defined(SPLINE_NEON)
+	float32x4_t origin = vdupq_n_f32(t0);
+	for (; k + LANE <= count; k += LANE) {
+		float32x4_t u = vsubq_f32(vld1q_f32(ts + k), origin);
+		vst1q_f32(out + k, Cubic(a[i], b[i], c[i], d[i], u));
+	}
+#endif
+	for (; k < count; ++k) {
+		out[k] = Cubic(a[i], b[i], c[i], d[i], ts[k] - t0);
+	}
+}
+
+void SplineCoefficients::EvalUniform(float t0, float step, float* out, int count) const {
+	int pieces = PieceCount();
+	if (pieces == 0 || count <= 0) return;
+
+	int i = Find(t0);
+	// Less than a batch per piece on average, walk sample by sample instead.
+	if (knots[pieces] - knots[0] < LANE * step * pieces) {
+		for (int j = 0; j < count; ++j) {
+			double t = t0 + static_cast<double>(j) * step;
+			while (i < pieces - 1 && t >= knots[i + 1]) ++i;
+			out[j] = Cubic(a[i], b[i], c[i], d[i], static_cast<float>(t - knots[i]));
+		}
+		return;
+	}
+	int k = 0;
+	while (k < count) {
+		// Samples up to the end of piece i, the last piece takes the rest.
+		int end = count;
+		if (i < pieces - 1) {
+			end = std::clamp(static_cast<int>(std::ceil((knots[i + 1] - t0) / step)), k, count);
+			// ceil() in float may land one sample off the knot.
+			while (end > k && t0 + (end - 1) * step >= knots[i + 1]) --end;
+			while (end < count && t0 + end * step < knots[i + 1]) ++end;
+		}
+		// u = t0 + j * step - t_i = (t0 - t_i) + j * step
+		float origin = t0 - knots[i];
+		int j = k;
+#if defined(SPLINE_AVX2)
+		__m256 lane = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+		__m256 stepV = _mm256_set1_ps(step);
+		for (; j + LANE <= end; j += LANE) {
+			__m256 u = MulAdd(_mm256_add_ps(_mm256_set1_ps(static_cast<float>(j)), lane), stepV, _mm256_set1_ps(origin));
+			_mm256_storeu_ps(out + j, Cubic(a[i], b[i], c[i], d[i], u));
+		}
+#elif defined(SPLINE_NEON)
+		const float lanes[LANE] = { 0, 1, 2, 3 };
+		float32x4_t lane = vld1q_f32(lanes);
+		float32x4_t stepV = vdupq_n_f32(step);
+		for (; j + LANE <= end; j += LANE) {
+			float32x4_t u = MulAdd(vaddq_f32(vdupq_n_f32(static_cast<float>(j)), lane), stepV, vdupq_n_f32(origin));
+			vst1q_f32(out + j, Cubic(a[i], b[i], c[i], d[i], u));
+		}
+#endif
+		// Far from t = 0, j * step rounded on its own is off by a large ulp,
+		// the tail sums in double.
+		for (; j < end; ++j) {
+			out[j] = Cubic(a[i], b[i], c[i], d[i], static_cast<float>(origin + static_cast<double>(j) * step));
+		}
+		k = end;
+		++i;
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+// Evaluation of a solved cubic spline. Every piece is turned once into power
+// basis coefficients, stored as structure of arrays, so a sample costs one
+// Horner step per degree instead of the moment form. Batches are vectorized
+// across samples (AVX2 / NEON, scalar otherwise). Define FITTING_NO_SIMD to
+// force the scalar path.
+
+#include <vector>
+
+// One value column of a spline with count knots and count - 1 pieces,
+//   y(t) = a_i + b_i * u + c_i * u^2 + d_i * u^3,  u = t - t_i,  t in [t_i, t_i+1].
+class SplineCoefficients {
+public:
+	// Every piece from the moments of SplineMoments.
+	void Build(const float* ts, const float* ys, const float* moments, int count);
+	// Piece i from its end values and moments, the knot count must be set by
+	// Build() or Resize(). Pieces may have different moments on either side of
+	// a knot, like the C0 / G1 controls of hw4.
+	void SetPiece(int i, float t0, float t1, float y0, float y1, float m0, float m1);
+	void Resize(int count);
+	// Move the knots without touching the coefficients, e.g. when the parameters
+	// after a dragged knot shifted but their pieces kept their shape.
+	void SetKnots(const float* ts, int count);
+
+	int PieceCount() const { return static_cast<int>(a.size()); }
+	float Knot(int i) const { return knots[i]; }
+
+	// Piece whose span holds t, the end pieces extend beyond the knots. Binary search.
+	int Find(float t) const;
+	// Find() starting from the piece of the last query, constant time for
+	// queries that walk along the curve.
+	int Find(float t, int& cursor) const;
+
+	float Eval(float t) const { return EvalPiece(Find(t), t); }
+	float EvalPiece(int i, float t) const;
+	// dy/dt of piece i at t
+	float DerivativePiece(int i, float t) const;
+	// d^2y/dt^2 of piece i at t
+	float SecondDerivativePiece(int i, float t) const;
+	// out[k] = y(ts[k]) on piece i, k in [0, count)
+	void EvalPiece(int i, const float* ts, float* out, int count) const;
+	// out[k] = y(t0 + k * step), k in [0, count), step > 0. Pieces are walked
+	// forward, every run of samples on one piece is one vectorized batch.
+	void EvalUniform(float t0, float step, float* out, int count) const;
+
+private:
+	// count knots
+	std::vector<float> knots;
+	// count - 1 coefficients each
+	std::vector<float> a;
+	std::vector<float> b;
+	std::vector<float> c;
+	std::vector<float> d;
+};
@@ -0,0 +1,261 @@
+#include "SplineSolver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+	// Tridiagonal system lower[i] * x[i - 1] + diag[i] * x[i] + upper[i] * x[i + 1] = r[i],
+	// lower[0] and upper[n - 1] unused. Factor once, then every column of the curve
+	// solves against the same elimination (Thomas algorithm).
+	class Thomas {
+	public:
+		// Rows are filled by the caller, then Factor() eliminates them in place.
+		void Resize(int newN) {
+			n = newN;
+			lower.resize(n);
+			diag.resize(n);
+			upper.resize(n);
+		}
+
+		void Factor() {
+			// upper[i] becomes c_i / pivot_i, diag[i] becomes 1 / (b_i - a_i * upper[i - 1]).
+			double prevUpper = 0;
+			for (int i = 0; i < n; ++i) {
+				double a = i > 0 ? lower[i] : 0.;
+				double inv = 1. / (diag[i] - a * prevUpper);
+				diag[i] = inv;
+				prevUpper = i < n - 1 ? upper[i] * inv : 0.;
+				upper[i] = prevUpper;
+			}
+		}
+
+		// r is overwritten by the solution.
+		void Solve(double* r) const {
+			double prev = 0;
+			for (int i = 0; i < n; ++i) {
+				double a = i > 0 ? lower[i] : 0.;
+				prev = (r[i] - a * prev) * diag[i];
+				r[i] = prev;
+			}
+			double next = 0;
+			for (int i = n - 1; i >= 0; --i) {
+				next = r[i] - upper[i] * next;
+				r[i] = next;
+			}
+		}
+
+		int n{ 0 };
+		std::vector<double> lower;
+		std::vector<double> diag;
+		std::vector<double> upper;
+	};
+
+	double Slope(const float* ts, const float* y, int i) {
+		return (double(y[i + 1]) - y[i]) / (double(ts[i + 1]) - ts[i]);
+	}
+
+	// Row of interior knot i, in system position row.
+	void InteriorRow(const float* ts, int i, Thomas& rows, int row) {
+		double hc = double(ts[i]) - ts[i - 1];
+		double hn = double(ts[i + 1]) - ts[i];
+		rows.lower[row] = hc;
+		rows.diag[row] = 2. * (hc + hn);
+		rows.upper[row] = hn;
+	}
+
+	// Solve the rows of the interior moments first..last (1 <= first <= last <= count - 2)
+	// with moments[d][first - 1] and moments[d][last + 1] held fixed.
+	void SolveRange(const float* ts, const float* const* columns, int dim, int first, int last, float* const* moments) {
+		int n = last - first + 1;
+		Thomas rows;
+		rows.Resize(n);
+		for (int i = 0; i < n; ++i) {
+			InteriorRow(ts, first + i, rows, i);
+		}
+		rows.Factor();
+
+		std::vector<double> r(n);
+		for (int d = 0; d < dim; ++d) {
+			const float* y = columns[d];
+			float* m = moments[d];
+			for (int i = 0; i < n; ++i) {
+				int k = first + i;
+				r[i] = 6. * (Slope(ts, y, k) - Slope(ts, y, k - 1));
+			}
+			// The fixed moments move to the right-hand side.
+			r[0] -= (double(ts[first]) - ts[first - 1]) * m[first - 1];
+			r[n - 1] -= (double(ts[last + 1]) - ts[last]) * m[last + 1];
+			rows.Solve(r.data());
+			for (int i = 0; i < n; ++i) {
+				m[first + i] = static_cast<float>(r[i]);
+			}
+		}
+	}
+
+	// Every knot is unknown, the end rows set the first derivative:
+	//   2 * h_0 * M_0 + h_0 * M_1 = 6 * (d_0 - s_start)
+	//   h_n-2 * M_n-2 + 2 * h_n-2 * M_n-1 = 6 * (s_end - d_n-2)
+	void SolveClamped(const float* ts, const float* const* columns, int dim, int count, float* const* moments,
+		const float* startSlopes, const float* endSlopes) {
+		Thomas rows;
+		rows.Resize(count);
+		double hStart = double(ts[1]) - ts[0];
+		double hEnd = double(ts[count - 1]) - ts[count - 2];
+		rows.diag[0] = 2. * hStart;
+		rows.upper[0] = hStart;
+		for (int i = 1; i < count - 1; ++i) {
+			InteriorRow(ts, i, rows, i);
+		}
+		rows.lower[count - 1] = hEnd;
+		rows.diag[count - 1] = 2. * hEnd;
+		rows.Factor();
+
+		std::vector<double> r(count);
+		for (int d = 0; d < dim; ++d) {
+			const float* y = columns[d];
+			double dStart = Slope(ts, y, 0);
+			double dEnd = Slope(ts, y, count - 2);
+			r[0] = 6. * (dStart - (startSlopes ? startSlopes[d] : dStart));
+			for (int i = 1; i < count - 1; ++i) {
+				r[i] = 6. * (Slope(ts, y, i) - Slope(ts, y, i - 1));
+			}
+			r[count - 1] = 6. * ((endSlopes ? endSlopes[d] : dEnd) - dEnd);
+			rows.Solve(r.data());
+			for (int i = 0; i < count; ++i) {
+				moments[d][i] = static_cast<float>(r[i]);
+			}
+		}
+	}
+
+	// n = count - 1 distinct knots on a loop, row i couples M_i-1 and M_i+1 mod n.
+	// The cyclic matrix is A' + u * v^T with A' tridiagonal, u = (gamma, 0.., alpha),
+	// v = (1, 0.., beta / gamma), and Sherman-Morrison gives
+	//   x = y - z * (v.y) / (1 + v.z),  A' y = r,  A' z = u.
+	void SolvePeriodic(const float* ts, const float* const* columns, int dim, int count, float* const* moments) {
+		int n = count - 1;
+		double hLoop = double(ts[n]) - ts[n - 1];
+		Thomas rows;
+		rows.Resize(n);
+		double h0 = double(ts[1]) - ts[0];
+		rows.diag[0] = 2. * (hLoop + h0);
+		rows.upper[0] = h0;
+		for (int i = 1; i < n - 1; ++i) {
+			InteriorRow(ts, i, rows, i);
+		}
+		rows.lower[n - 1] = double(ts[n - 1]) - ts[n - 2];
+		rows.diag[n - 1] = 2. * (rows.lower[n - 1] + hLoop);
+		// Both corners are h_n-1, the segment closing the loop.
+		double alpha = hLoop;
+		double beta = hLoop;
+		double gamma = -rows.diag[0];
+		rows.diag[0] -= gamma;
+		rows.diag[n - 1] -= alpha * beta / gamma;
+		rows.Factor();
+
+		std::vector<double> z(n, 0.);
+		z[0] = gamma;
+		z[n - 1] = alpha;
+		rows.Solve(z.data());
+		double vz = z[0] + beta * z[n - 1] / gamma;
+
+		std::vector<double> r(n);
+		for (int d = 0; d < dim; ++d) {
+			const float* y = columns[d];
+			r[0] = 6. * (Slope(ts, y, 0) - Slope(ts, y, n - 1));
+			for (int i = 1; i < n; ++i) {
+				r[i] = 6. * (Slope(ts, y, i) - Slope(ts, y, i - 1));
+			}
+			rows.Solve(r.data());
+			double factor = (r[0] + beta * r[n - 1] / gamma) / (1. + vz);
+			for (int i = 0; i < n; ++i) {
+				moments[d][i] = static_cast<float>(r[i] - factor * z[i]);
+			}
+			moments[d][n] = moments[d][0];
+		}
+	}
+}
+
+void SplineMoments(const float* ts, const float* const* columns, int dim, int count, float* const* moments,
+	SplineBoundary boundary, const float* startSlopes, const float* endSlopes) {
+	if (count <= 0) return;
+	for (int d = 0; d < dim; ++d) {
+		std::fill(moments[d], moments[d] + count, 0.f);
+	}
+	if (boundary == Clamped && count >= 2) {
+		SolveClamped(ts, columns, dim, count, moments, startSlopes, endSlopes);
+		return;
+	}
+	// A loop needs 3 distinct knots, fewer fall back to natural.
+	if (boundary == Periodic && count >= 4) {
+		SolvePeriodic(ts, columns, dim, count, moments);
+		return;
+	}
+	if (count <= 2) return;
+	SolveRange(ts, columns, dim, 1, count - 2, moments);
+}
+
+void IncrementalSpline::Solve(const float* ts, const float* const* columns, int newDim, int newCount,
+	SplineBoundary newBoundary, const float* newStartSlopes, const float* newEndSlopes) {
+	dim = newDim;
+	count = newCount;
+	boundary = newBoundary;
+	if (newStartSlopes != startSlopes.data()) {
+		startSlopes.assign(newStartSlopes, newStartSlopes ? newStartSlopes + dim : nullptr);
+	}
+	if (newEndSlopes != endSlopes.data()) {
+		endSlopes.assign(newEndSlopes, newEndSlopes ? newEndSlopes + dim : nullptr);
+	}
+	moments.resize(dim * count);
+	std::vector<float*> ms(dim);
+	for (int d = 0; d < dim; ++d) {
+		ms[d] = moments.data() + d * count;
+	}
+	SplineMoments(ts, columns, dim, count, ms.data(), boundary,
+		startSlopes.empty() ? nullptr : startSlopes.data(), endSlopes.empty() ? nullptr : endSlopes.data());
+}
+
+std::pair<int, int> IncrementalSpline::Update(const float* ts, const float* const* columns, int index, float tolerance) {
+	if (count <= 2) return { 0, count - 2 };
+
+	std::vector<float*> ms(dim);
+	for (int d = 0; d < dim; ++d) {
+		ms[d] = moments.data() + d * count;
+	}
+	std::vector<float> oldFirst(dim);
+	std::vector<float> oldLast(dim);
+	int first, last;
+	for (int radius = INITIAL_RADIUS; ; radius *= 2) {
+		first = std::max(index - radius, 1);
+		last = std::min(index + radius, count - 2);
+		// Only natural ends are fixed moments, other end rows need the whole system.
+		if (boundary != Natural && (first == 1 || last == count - 2)) {
+			Solve(ts, columns, dim, count, boundary,
+				startSlopes.empty() ? nullptr : startSlopes.data(), endSlopes.empty() ? nullptr : endSlopes.data());
+			return { 0, count - 2 };
+		}
+		for (int d = 0; d < dim; ++d) {
+			oldFirst[d] = ms[d][first];
+			oldLast[d] = ms[d][last];
+		}
+		SolveRange(ts, columns, dim, first, last, ms.data());
+		if (first == 1 && last == count - 2) break;
+
+		// A moment change delta at the edge bends its pieces by at most delta * h^2 / 8,
+		// what the moments outside would have moved is smaller still.
+		float error = 0;
+		for (int d = 0; d < dim; ++d) {
+			if (first > 1) {
+				float h = std::max(ts[first] - ts[first - 1], ts[first + 1] - ts[first]);
+				error = std::max(error, std::abs(ms[d][first] - oldFirst[d]) * h * h * 0.125f);
+			}
+			if (last < count - 2) {
+				float h = std::max(ts[last] - ts[last - 1], ts[last + 1] - ts[last]);
+				error = std::max(error, std::abs(ms[d][last] - oldLast[d]) * h * h * 0.125f);
+			}
+		}
+		if (error <= tolerance) break;
+	}
+	// Piece i depends on M_i and M_i+1.
+	return { first - 1, last };
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+// Plain float array entry points of the hw4 spline math, no ImGui or Utopia
+// types, so they also build in bench/.
+//
+// Moments are the second derivatives M_i of the interpolating cubic at its
+// knots. With h_i = t_i+1 - t_i the interior knots satisfy
+//   h_i-1 * M_i-1 + 2 * (h_i-1 + h_i) * M_i + h_i * M_i+1 = 6 * (d_i - d_i-1),
+// d_i = (y_i+1 - y_i) / h_i. The system is tridiagonal and strictly diagonally
+// dominant, the Thomas algorithm solves it in O(n) time and memory.
+
+#include <utility>
+#include <vector>
+
+// End conditions of the spline.
+enum SplineBoundary {
+	Natural = 1, // M_0 = M_n-1 = 0
+	Clamped,     // first derivatives given at both ends
+	Periodic,    // closed loop, the last knot repeats the first one
+};
+
+// Moments of the spline through columns over the knots ts. columns[d] are value
+// columns sharing the knots (x and y of a curve), they share one elimination.
+// moments[d] gets count moments of column d.
+// Clamped: startSlopes[d] / endSlopes[d] are dy/dt at the ends, nullptr keeps
+// the slope of the end chord.
+// Periodic: columns[d][count - 1] == columns[d][0] and ts[count - 1] is where
+// the loop returns to the first knot. The cyclic system is solved with
+// Sherman-Morrison on two Thomas solves, still O(n); moments[d][count - 1]
+// equals moments[d][0].
+void SplineMoments(const float* ts, const float* const* columns, int dim, int count, float* const* moments,
+	SplineBoundary boundary = Natural, const float* startSlopes = nullptr, const float* endSlopes = nullptr);
+inline void SplineMoments(const float* ts, const float* ys, int count, float* moments) {
+	SplineMoments(ts, &ys, 1, count, &moments);
+}
+
+// Spline moments kept between frames for dragging one knot. The change
+// of a moment decays at least by half per knot away from the edit (every
+// off-diagonal is below half the diagonal), so Update() re-solves a window
+// around the knot and grows it until the change at its edges bends the curve
+// by less than tolerance. Outside the window the moments are left as they
+// were, call Solve() when the drag ends to drop the accumulated error.
+// Clamped and periodic ends are not fixed moments, a window reaching them
+// solves in full.
+class IncrementalSpline {
+public:
+	void Solve(const float* ts, const float* const* columns, int dim, int count,
+		SplineBoundary boundary = Natural, const float* startSlopes = nullptr, const float* endSlopes = nullptr);
+	// Knot index moved, ts and columns differ from the last call only around it
+	// (later ts may be shifted by a constant). Returns the pieces [first, last]
+	// whose moments changed, piece i spans knots i and i + 1.
+	std::pair<int, int> Update(const float* ts, const float* const* columns, int index, float tolerance);
+
+	int Count() const { return count; }
+	SplineBoundary Boundary() const { return boundary; }
+	const float* Moments(int d) const { return moments.data() + d * count; }
+
+private:
+	// Knots on either side re-solved first, doubled until the tolerance is met.
+	static constexpr int INITIAL_RADIUS = 8;
+
+	int dim{ 0 };
+	int count{ 0 };
+	SplineBoundary boundary{ Natural };
+	// Clamped end slopes per column, empty for the end chord.
+	std::vector<float> startSlopes;
+	std::vector<float> endSlopes;
+	// count moments per column
+	std::vector<float> moments;
+};
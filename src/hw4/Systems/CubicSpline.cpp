@@ -1,6 +1,23 @@
 #include "CubicSpline.h"
+#include "PickGrid.h"
+#include "../Spline/ArcLength.h"
+#include "../Spline/SmoothingSpline.h"
+#include "../Spline/SplineBVH.h"
+#include "../Spline/SplineEval.h"
+#include "../Spline/SplineSolver.h"
+#include "../../Common/Parameterization.h"
+#include "../../Common/Tessellate.h"
 
 constexpr float CONTROL_POINT_RADIUS = 8;
+// Chord error of the drawn spline, in pixels.
+constexpr float CURVE_TOLERANCE = 0.25f;
+// Uniform pieces a spline segment starts from before adaptive bisection.
+constexpr int CURVE_SEGMENTS = 4;
+
+// Picking indices, kept in step with every edit of data->xs/ys and the handles.
+// Knots by index, handles of selected controls by 2 * index (p1) and 2 * index + 1 (p2).
+static PickGrid knotGrid(2 * CONTROL_POINT_RADIUS);
+static PickGrid handleGrid(2 * CONTROL_POINT_RADIUS);
 
 void DebugTrigger(CanvasData* data) {
 	if (data->enableDebug) {
@@ -14,12 +31,6 @@ void ShowDebugInfo(CanvasData* data) {
 	ImGui::Text(data->debugInfo.c_str());
 }
 
-enum ParamMode {
-	Uniform = 1,
-	Chordal, // Radian length
-	Centripetal,  // Sqrt radian length
-};
-
 ImVec2 operator+ (const ImVec2& v1, const ImVec2& v2) {
 	return ImVec2(v1.x + v2.x, v1.y + v2.y);
 }
@@ -86,75 +97,58 @@ void ClearSelectPoint(CanvasData* data) {
 	for (int i = 0; i < data->controls.size(); ++i) {
 		data->controls[i].isSelect = false;
 	}
+	handleGrid.Clear();
 }
 
-int SelectPoint(const ImVec2& canvasPos, float searchRadius, const std::vector<float>& xs, const std::vector<float>& ys) {
-	for (int i = 0; i < xs.size(); ++i) {
-		if (std::abs(canvasPos.x - xs[i]) < searchRadius && std::abs(canvasPos.y - ys[i]) < searchRadius) {
-			return i;
-		}
-	}return -1;
+// Index the handles of control ix if it is selected, call after p1/p2 or isSelect change.
+void UpdateHandles(int ix, const ControlPoint& control) {
+	if (control.isSelect) {
+		handleGrid.Set(2 * ix, control.p1.x, control.p1.y);
+		handleGrid.Set(2 * ix + 1, control.p2.x, control.p2.y);
+	}
+	else {
+		handleGrid.Remove(2 * ix);
+		handleGrid.Remove(2 * ix + 1);
+	}
 }
 
-int SelectPoint(const ImVec2& canvasPos, float searchRadius, const std::vector<ControlPoint>& controls, bool& outIsP1) {
-	for (int i = 0; i < controls.size(); ++i) {
-		const ControlPoint control = controls[i];
-		if (!control.isSelect) continue;
+// Rebuild the knot index when data changed behind our back, e.g. loaded from a
+// scene or replaced by another system with as many points. O(n), only on a click.
+void SyncKnotGrid(const CanvasData* data) {
+	int n = static_cast<int>(data->xs.size());
+	bool current = knotGrid.Size() == n;
+	for (int i = 0; current && i < n; ++i) {
+		current = knotGrid.IsAt(i, data->xs[i], data->ys[i]);
+	}
+	if (current) return;
+	knotGrid.Clear();
+	for (int i = 0; i < n; ++i) {
+		knotGrid.Set(i, data->xs[i], data->ys[i]);
+	}
+}
 
-		if (std::abs(canvasPos.x - control.p1.x) < searchRadius && std::abs(canvasPos.y - control.p1.y) < searchRadius) {
-			outIsP1 = true;
-			return i;
-		}
-		else if (std::abs(canvasPos.x - control.p2.x) < searchRadius && std::abs(canvasPos.y - control.p2.y) < searchRadius) {
-			outIsP1 = false;
-			return i;
-		}
-	}return -1;
+int SelectPoint(const ImVec2& canvasPos, float searchRadius, const PickGrid& knots) {
+	return knots.Nearest(canvasPos.x, canvasPos.y, searchRadius);
 }
 
-std::vector<float> Parameterization2(const std::vector<float>& xs, const std::vector<float>& ys, ParamMode mode, float tInterval) {
-	int n = xs.size();
-	std::vector<float> t(n);
-	if (n < 1) return t;
-
-	switch (mode)
-	{
-	case Uniform:
-		t[0] = 0;
-		for (int i = 1; i < n; ++i) {
-			t[i] = t[i - 1] + tInterval;
-		}
-		break;
-	case Chordal:
-		t[0] = 0;
-		for (int i = 1; i < n; ++i) {
-			float xDiff = xs[i] - xs[i - 1];
-			float yDiff = ys[i] - ys[i - 1];
-			t[i] = t[i - 1] + std::sqrt(xDiff * xDiff + yDiff * yDiff);
-		}
-		break;
-	case Centripetal:
-		t[0] = 0;
-		for (int i = 1; i < n; ++i) {
-			float xDiff = xs[i] - xs[i - 1];
-			float yDiff = ys[i] - ys[i - 1];
-			t[i] = t[i - 1] + pow(xDiff * xDiff + yDiff * yDiff, 0.25);
-		}
-		break;
-	}
-	return t;
+// Control whose handle is under canvasPos, only selected controls have their handles indexed.
+int SelectPoint(const ImVec2& canvasPos, float searchRadius, const PickGrid& handles, bool& outIsP1) {
+	int id = handles.Nearest(canvasPos.x, canvasPos.y, searchRadius);
+	if (id == -1) return -1;
+	outIsP1 = id % 2 == 0;
+	return id / 2;
 }
 
+// One polyline per curve.
 void Draw(const std::vector<ImVec2>& points, const ImVec2& canvasOrigin, const ImVec2& canvasSize, ImDrawList* drawList, const ImU32& color) {
-	if (points.size() < 1) return;
+	if (points.size() < 2) return;
 
 	ImVec2 canvasDiagonal = canvasOrigin + canvasSize;
-	ImVec2 prePoint = ImVec2(canvasOrigin.x + points[0].x, canvasDiagonal.y - points[0].y);
-	for (int i = 1; i < points.size(); ++i) {
-		ImVec2 curPoint = ImVec2(canvasOrigin.x + points[i].x, canvasDiagonal.y - points[i].y);
-		drawList->AddLine(prePoint, curPoint, color, 2.0);
-		prePoint = std::move(curPoint);
+	std::vector<ImVec2> screen(points.size());
+	for (int i = 0; i < points.size(); ++i) {
+		screen[i] = ImVec2(canvasOrigin.x + points[i].x, canvasDiagonal.y - points[i].y);
 	}
+	drawList->AddPolyline(screen.data(), screen.size(), color, false, 2.0f);
 }
 
 void DrawPoint(CanvasData* data, ImDrawList* drawList, const ImVec2& canvasOrigin, const ImVec2& canvasDiagonal) {
@@ -208,149 +202,171 @@ void DrawSelectGizmo(CanvasData* data, ImDrawList* drawList, const ImVec2& canva
 	}
 }
 
-void OneCubicSpline(std::vector<ImVec2>& fitPoints, float mc, float mn, float xc, float xn, float yc, float yn, float delta) {
-	float constant = 1. / 6;
-	float hc = xn - xc;
-	float invHc = 1 / hc;
-	float coefMC = mc * constant * invHc;
-	float coefMN = mn * constant * invHc;
-	float DIntegrateCoef = yn * invHc - mn * hc * constant;
-	float CIntegrateCoef = yc * invHc - mc * hc * constant;
-
-	float y = 0;
-	float x = xc;
-
-	int size = ceil((xn - xc) / delta);
-	int startIx = fitPoints.size();
-	fitPoints.resize(size + fitPoints.size());
-
-	for (int i = startIx; i < fitPoints.size(); ++i) {
-		x = std::min(xn, x);
-		y = coefMC * pow(xn - x, 3) +
-			coefMN * pow(x - xc, 3) +
-			(x - xc) * DIntegrateCoef +
-			(xn - x) * CIntegrateCoef;
-		fitPoints[i][0] = x;
-		fitPoints[i][1] = y;
-		x += delta;
+// Tessellated pieces of the drawn spline, piece i spans knots i and i + 1.
+// While a knot is dragged only the pieces around it are re-solved and
+// re-sampled, see IncrementalSpline in Spline/SplineSolver.h.
+struct SplineCache {
+	IncrementalSpline spline;
+	// Power basis of every piece, x and y of a curve, y of a function.
+	SplineCoefficients coeffs[2];
+	// x(t) = t of a function, so it is queried like a curve.
+	SplineCoefficients line;
+	// Boxes over the pieces for hover queries, refit with the re-solved pieces.
+	SplineBVH bvh;
+	// Arc length of a curve sampled at constant speed, pieces is unused then.
+	ArcLengthTable arcLength;
+	std::vector<std::vector<ImVec2>> pieces;
+	// Knot whose drag the moments follow, -1 after a full solve outside a drag.
+	int dragIndex{ -1 };
+	bool curve{ false };
+	bool arcLengthSampling{ false };
+	// Closing knot and end slopes of the last loop / clamped curve.
+	std::vector<float> loopXs;
+	std::vector<float> loopYs;
+	float startSlopes[2];
+	float endSlopes[2];
+};
+static SplineCache splineCache;
+
+// Moments of the spline through count knots over ts, returns the pieces
+// [first, last] to re-sample. The first frame of a drag and its release solve in full.
+std::pair<int, int> SolveSpline(const CanvasData* data, bool curve, const float* ts, const float* const* columns, int dim, int count,
+	SplineBoundary boundary = Natural, const float* startSlopes = nullptr, const float* endSlopes = nullptr) {
+	SplineCache& cache = splineCache;
+	bool incremental = data->enableIncrementalDrag
+		&& data->movePoint != -1
+		&& data->movePoint == cache.dragIndex
+		&& curve == cache.curve
+		&& count == cache.spline.Count()
+		&& boundary == cache.spline.Boundary()
+		&& data->arcLengthSampling == cache.arcLengthSampling;
+	cache.curve = curve;
+	cache.arcLengthSampling = data->arcLengthSampling;
+	cache.pieces.resize(count - 1);
+	for (int d = 0; d < dim; ++d) {
+		if (cache.coeffs[d].PieceCount() != count - 1) cache.coeffs[d].Resize(count);
 	}
-}
-
-// ԽǾϸĶԽռž(֤ʽԼ˳ʽʽ0)
-// |a_i_i| > |a_i_i-1| + |a_i_i+1|
-Eigen::MatrixXf ConstructDiagonalMatrix(const std::vector<float>& xs) {
-	// n+1 points; n cubicSpline; n-1 equation group count.
-	int n = xs.size() - 1;
-	Eigen::MatrixXf m = Eigen::MatrixXf::Zero(n - 1, n - 1);
-
-	// Init diagonal element
-	for (int i = 0; i < n - 1; ++i) {
-		int leftIx = i - 1;
-		int majorIx = i;
-		int rightIx = i + 1;
-
-		// h_i = x_i+1 - x_i
-		if (leftIx >= 0) {
-			m(i, leftIx) = xs[i + 1] - xs[i];
-		}
-		if (rightIx < n - 1) {
-			m(i, rightIx) = xs[i + 2] - xs[i + 1];
-		}
-		// u = 2 * (h_i-1 + h_i)
-		m(i, majorIx) = 2 * (xs[i + 1] - xs[i] + xs[i + 2] - xs[i + 1]);
+	if (incremental) {
+		return cache.spline.Update(ts, columns, data->movePoint, data->dragTolerance);
 	}
-	return m;
+	cache.spline.Solve(ts, columns, dim, count, boundary, startSlopes, endSlopes);
+	cache.dragIndex = data->movePoint;
+	return { 0, count - 2 };
 }
 
-Eigen::VectorXf PursueSolver(Eigen::MatrixXf& diagonalMatrix, Eigen::VectorXf& values, float m0 = 0, float mn = 0) {
-	assert(diagonalMatrix.rows() == diagonalMatrix.cols());
-	assert(values.size() == diagonalMatrix.rows());
-
-	int n = diagonalMatrix.rows() + 1;
-	Eigen::VectorXf b(n + 1);
-	// Translate to triangle matrix.
-	for (int i = 1; i < n - 1; ++i) {
-		float coef = diagonalMatrix(i, i - 1) / diagonalMatrix(i - 1, i - 1);
-		diagonalMatrix(i, i) -= coef * diagonalMatrix(i - 1, i);
-		values(i) -= coef * values(i - 1);
-		diagonalMatrix(i, i - 1) = 0;
-	}
-
-	b(n - 1) = values(n - 2) / diagonalMatrix(n - 2, n - 2);
-	for (int i = n - 3; i >= 0; --i) {
-		b(i + 1) = (values(i) - b(i + 2) * diagonalMatrix(i, i + 1)) / diagonalMatrix(i, i);
-	}
-
-	b(0) = m0;
-	b(n) = mn;
-	return b;
+// Point of the last drawn spline nearest to (x, y) within maxDistance.
+CurveHit NearestOnSpline(float x, float y, float maxDistance) {
+	const SplineCache& cache = splineCache;
+	const SplineCoefficients& xCoeffs = cache.curve ? cache.coeffs[0] : cache.line;
+	const SplineCoefficients& yCoeffs = cache.curve ? cache.coeffs[1] : cache.coeffs[0];
+	return cache.bvh.Nearest(xCoeffs, yCoeffs, x, y, maxDistance);
 }
 
-Eigen::VectorXf CubicSplineM(const std::vector<float>& xs, const std::vector<float>& ys, float delta)
-{
-	assert(xs.size() == ys.size());
-	int n = xs.size() - 1;
-	Eigen::VectorXf values(n - 1);
-
-	// Construct values
-	for (int i = 1; i < n; ++i) {
-		// n represent i+1, c represent i.
-		float yn = ys[i + 1] - ys[i];
-		float yc = ys[i] - ys[i - 1];
-		float hn = xs[i + 1] - xs[i];
-		float hc = xs[i] - xs[i - 1];
-		values[i - 1] = 6 * (1 / hn * yn - 1 / hc * yc);
+// Chain the cached pieces into one polyline.
+std::vector<ImVec2> SplinePoints() {
+	std::vector<ImVec2> points;
+	for (const std::vector<ImVec2>& piece : splineCache.pieces) {
+		if (piece.empty()) continue;
+		points.insert(points.end(), piece.begin() + (points.empty() ? 0 : 1), piece.end());
 	}
-
-	std::vector<ImVec2> fitPoints;
-
-	Eigen::MatrixXf diagonalMatrix = std::move(ConstructDiagonalMatrix(xs));
-	Eigen::VectorXf m = std::move(PursueSolver(diagonalMatrix, values));
-
-	return m;
+	return points;
 }
 
-std::vector<ImVec2> CubicSplineFn(const std::vector<float>& xs, const std::vector<float>& ys, float delta)
+std::vector<ImVec2> CubicSplineFn(const CanvasData* data)
 {
-	const Eigen::VectorXf& m = CubicSplineM(xs, ys, delta);
+	const std::vector<float>& xs = data->xs;
+	const std::vector<float>& ys = data->ys;
+	const float* columns[] = { ys.data() };
+	auto [first, last] = SolveSpline(data, false, xs.data(), columns, 1, xs.size());
+	const float* m = splineCache.spline.Moments(0);
 	// Here to control m.
-	std::vector<ImVec2> fitPoints;
-
-	for (int i = 0; i < m.size() - 1; ++i) {
-		OneCubicSpline(fitPoints, m(i), m(i + 1), xs[i], xs[i + 1], ys[i], ys[i + 1], delta);
+	SplineCoefficients& coeffs = splineCache.coeffs[0];
+	SplineCoefficients& line = splineCache.line;
+	if (line.PieceCount() != coeffs.PieceCount()) line.Resize(xs.size());
+
+	std::vector<float> values;
+	for (int i = first; i <= last; ++i) {
+		coeffs.SetPiece(i, xs[i], xs[i + 1], ys[i], ys[i + 1], m[i], m[i + 1]);
+		line.SetPiece(i, xs[i], xs[i + 1], xs[i], xs[i + 1], 0, 0);
+		auto piece = [&](const float* at, int count, ImVec2* ps) {
+			values.resize(count);
+			coeffs.EvalPiece(i, at, values.data(), count);
+			for (int j = 0; j < count; ++j) {
+				ps[j] = ImVec2(at[j], values[j]);
+			}
+		};
+		std::vector<ImVec2>& fitPoints = splineCache.pieces[i];
+		fitPoints.clear();
+		Tessellate(piece, xs[i], xs[i + 1], CURVE_TOLERANCE, data->delta, CURVE_SEGMENTS, fitPoints);
 	}
+	splineCache.bvh.Refit(line, coeffs, first, last);
 
-	return fitPoints;
+	return SplinePoints();
 }
 
-void CubicSplineCurve(CanvasData* data, ImDrawList* drawList, const ImVec2& canvasOrigin, const ImVec2& canvasSize) {
-	const std::vector<float>& t = data->ts;
-	Eigen::VectorXf xm = std::move(CubicSplineM(t, data->xs, data->tDelta));
-	Eigen::VectorXf ym = std::move(CubicSplineM(t, data->ys, data->tDelta));
+// Knots of the curve, a periodic curve repeats its first knot at the end.
+void CurveKnots(const CanvasData* data, const std::vector<float>*& xs, const std::vector<float>*& ys) {
+	xs = &data->xs;
+	ys = &data->ys;
+	if (data->boundaryMode != Periodic) return;
+	SplineCache& cache = splineCache;
+	cache.loopXs.assign(data->xs.begin(), data->xs.end());
+	cache.loopYs.assign(data->ys.begin(), data->ys.end());
+	cache.loopXs.push_back(data->xs.front());
+	cache.loopYs.push_back(data->ys.front());
+	xs = &cache.loopXs;
+	ys = &cache.loopYs;
+}
 
+// data->ts holds one parameter per knot of CurveKnots().
+void CubicSplineCurve(CanvasData* data, const std::vector<float>& xs, const std::vector<float>& ys, ImDrawList* drawList, const ImVec2& canvasOrigin, const ImVec2& canvasSize) {
+	const std::vector<float>& t = data->ts;
 	std::vector<ControlPoint>& controls = data->controls;
-	for (int i = 0; i < controls.size(); ++i) {
+	int controlCount = controls.size();
+	SplineBoundary boundary = static_cast<SplineBoundary>(data->boundaryMode);
+	// Clamped ends follow the handles a user set (not C2), otherwise the end chords.
+	const float* startSlopes = nullptr;
+	const float* endSlopes = nullptr;
+	if (boundary == Clamped) {
+		const ControlPoint& start = controls.front();
+		const ControlPoint& end = controls.back();
+		splineCache.startSlopes[0] = start.xdRight;
+		splineCache.startSlopes[1] = start.ydRight;
+		splineCache.endSlopes[0] = end.xdLeft;
+		splineCache.endSlopes[1] = end.ydLeft;
+		if (start.mode != C2) startSlopes = splineCache.startSlopes;
+		if (end.mode != C2) endSlopes = splineCache.endSlopes;
+	}
+	// x and y share the knots t, so they share one elimination.
+	const float* columns[] = { xs.data(), ys.data() };
+	auto [first, last] = SolveSpline(data, true, t.data(), columns, 2, t.size(), boundary, startSlopes, endSlopes);
+	const float* xm = splineCache.spline.Moments(0);
+	const float* ym = splineCache.spline.Moments(1);
+
+	// The derivatives at a control come from the pieces on both sides,
+	// the knot closing a loop is control 0 again.
+	for (int i = first; i <= std::min(last + 1, controlCount - 1); ++i) {
 		ControlPoint& control = controls[i];
 		switch (control.mode)
 		{
 		case C2:
-			control.xmLeft = xm(i);
-			control.xmRight = xm(i);
-			control.ymLeft = ym(i);
-			control.ymRight = ym(i);
+			control.xmLeft = xm[i];
+			control.xmRight = xm[i];
+			control.ymLeft = ym[i];
+			control.ymRight = ym[i];
 			if (i == 0) {
-				float xd = CalcD(xm(i), xm(i + 1), t[i], t[i + 1], data->xs[i], data->xs[i + 1]);
+				float xd = CalcD(xm[i], xm[i + 1], t[i], t[i + 1], xs[i], xs[i + 1]);
 				control.xdLeft = xd;
 				control.xdRight = xd;
-				float yd = CalcD(ym(i), ym(i + 1), t[i], t[i + 1], data->ys[i], data->ys[i + 1]);
+				float yd = CalcD(ym[i], ym[i + 1], t[i], t[i + 1], ys[i], ys[i + 1]);
 				control.ydLeft = yd;
 				control.ydRight = yd;
 			}
 			else {
-				float xd = CalcDTail(xm(i - 1), xm(i), t[i - 1], t[i], data->xs[i - 1], data->xs[i]);
+				float xd = CalcDTail(xm[i - 1], xm[i], t[i - 1], t[i], xs[i - 1], xs[i]);
 				control.xdLeft = xd;
 				control.xdRight = xd;
-				float yd = CalcDTail(ym(i - 1), ym(i), t[i - 1], t[i], data->ys[i - 1], data->ys[i]);
+				float yd = CalcDTail(ym[i - 1], ym[i], t[i - 1], t[i], ys[i - 1], ys[i]);
 				control.ydLeft = yd;
 				control.ydRight = yd;
 			}
@@ -358,26 +374,101 @@ void CubicSplineCurve(CanvasData* data, ImDrawList* drawList, const ImVec2& canv
 			control.p1.y = data->ys[i] - control.ydLeft * data->derivativeMul;
 			control.p2.x = data->xs[i] + control.xdRight * data->derivativeMul;
 			control.p2.y = data->ys[i] + control.ydRight * data->derivativeMul;
+			UpdateHandles(i, control);
 			break;
 		}
 	}
 
-	std::vector<ImVec2> xs;
-	std::vector<ImVec2> ys;
-	for (int i = 0; i < controls.size() - 1; ++i) {
-		OneCubicSpline(xs, controls[i].xmRight, controls[i + 1].xmLeft, t[i], t[i + 1], data->xs[i], data->xs[i + 1], data->tDelta);
-		OneCubicSpline(ys, controls[i].ymRight, controls[i + 1].ymLeft, t[i], t[i + 1], data->ys[i], data->ys[i + 1], data->tDelta);
+	SplineCoefficients& xCoeffs = splineCache.coeffs[0];
+	SplineCoefficients& yCoeffs = splineCache.coeffs[1];
+	// Pieces after a dragged knot keep their shape but may move along t.
+	xCoeffs.SetKnots(t.data(), t.size());
+	yCoeffs.SetKnots(t.data(), t.size());
+	std::vector<float> xValues;
+	std::vector<float> yValues;
+	for (int i = first; i <= last; ++i) {
+		const ControlPoint& c = controls[i];
+		const ControlPoint& n = controls[(i + 1) % controlCount];
+		xCoeffs.SetPiece(i, t[i], t[i + 1], xs[i], xs[i + 1], c.xmRight, n.xmLeft);
+		yCoeffs.SetPiece(i, t[i], t[i + 1], ys[i], ys[i + 1], c.ymRight, n.ymLeft);
+		if (data->arcLengthSampling) continue;
+		auto piece = [&](const float* at, int count, ImVec2* points) {
+			xValues.resize(count);
+			yValues.resize(count);
+			xCoeffs.EvalPiece(i, at, xValues.data(), count);
+			yCoeffs.EvalPiece(i, at, yValues.data(), count);
+			for (int j = 0; j < count; ++j) {
+				points[j] = ImVec2(xValues[j], yValues[j]);
+			}
+		};
+		std::vector<ImVec2>& ps = splineCache.pieces[i];
+		ps.clear();
+		Tessellate(piece, t[i], t[i + 1], CURVE_TOLERANCE, data->tDelta, CURVE_SEGMENTS, ps);
 	}
+	// Shifting along t keeps a piece's shape, only the re-solved boxes change.
+	splineCache.bvh.Refit(xCoeffs, yCoeffs, first, last);
 
-	std::vector<ImVec2> ps(xs.size());
-	for (int i = 0; i < ps.size(); ++i) {
-		ps[i][0] = xs[i][1];
-		ps[i][1] = ys[i][1];
+	if (!data->arcLengthSampling) {
+		Draw(SplinePoints(), canvasOrigin, canvasSize, drawList, IM_COL32(0, 255, 0, 255));
+		return;
+	}
+	// Equal spacing along the curve, only the re-solved pieces are integrated again.
+	ArcLengthTable& arcLength = splineCache.arcLength;
+	if (arcLength.PieceCount() != xCoeffs.PieceCount() || (first == 0 && last == xCoeffs.PieceCount() - 1)) {
+		arcLength.Build(xCoeffs, yCoeffs);
+	}
+	else {
+		arcLength.Update(xCoeffs, yCoeffs, first, last);
+	}
+	std::vector<float> sampleTs;
+	std::vector<int> samplePieces;
+	arcLength.EqualSpaced(xCoeffs, yCoeffs, data->arcSpacing, sampleTs, samplePieces);
+	std::vector<ImVec2> ps(sampleTs.size());
+	for (int k = 0; k < sampleTs.size(); ++k) {
+		ps[k] = ImVec2(xCoeffs.EvalPiece(samplePieces[k], sampleTs[k]), yCoeffs.EvalPiece(samplePieces[k], sampleTs[k]));
 	}
-
 	Draw(ps, canvasOrigin, canvasSize, drawList, IM_COL32(0, 255, 0, 255));
 }
 
+// Smoothing spline of the knots, drawn over the interpolating one. dim 1 is a
+// function y(t), dim 2 a curve (x(t), y(t)).
+std::vector<ImVec2> SmoothingSplinePoints(const float* ts, const float* const* columns, int dim, int count, float lambda, float minStep) {
+	std::vector<float> values[2];
+	std::vector<float> moments[2];
+	float* vs[2];
+	float* ms[2];
+	for (int d = 0; d < dim; ++d) {
+		values[d].resize(count);
+		moments[d].resize(count);
+		vs[d] = values[d].data();
+		ms[d] = moments[d].data();
+	}
+	SmoothingSpline(ts, columns, dim, count, lambda, vs, ms);
+	SplineCoefficients coeffs[2];
+	for (int d = 0; d < dim; ++d) {
+		coeffs[d].Build(ts, vs[d], ms[d], count);
+	}
+
+	std::vector<ImVec2> points;
+	std::vector<float> first;
+	std::vector<float> second;
+	for (int i = 0; i + 1 < count; ++i) {
+		auto piece = [&](const float* at, int n, ImVec2* ps) {
+			first.resize(n);
+			coeffs[0].EvalPiece(i, at, first.data(), n);
+			if (dim == 2) {
+				second.resize(n);
+				coeffs[1].EvalPiece(i, at, second.data(), n);
+			}
+			for (int j = 0; j < n; ++j) {
+				ps[j] = dim == 2 ? ImVec2(first[j], second[j]) : ImVec2(at[j], first[j]);
+			}
+		};
+		Tessellate(piece, ts[i], ts[i + 1], CURVE_TOLERANCE, minStep, CURVE_SEGMENTS, points);
+	}
+	return points;
+}
+
 void CubicSpline::OnUpdate(UECS::Schedule& schedule)
 {
 	schedule.RegisterCommand([](UECS::World* w)->void {
@@ -395,8 +486,22 @@ void CubicSpline::OnUpdate(UECS::Schedule& schedule)
 			ImGui::RadioButton("chordal", &data->paramMode, 2);
 			ImGui::SameLine(0);
 			ImGui::RadioButton("centripetal", &data->paramMode, 3);
+			ImGui::RadioButton("natural", &data->boundaryMode, 1);
+			ImGui::SameLine(0);
+			ImGui::RadioButton("clamped", &data->boundaryMode, 2);
+			ImGui::SameLine(0);
+			ImGui::RadioButton("periodic", &data->boundaryMode, 3);
 			ImGui::PushItemWidth(80);
 			ImGui::InputFloat("showDerivativeMul", &data->derivativeMul);
+			ImGui::Checkbox("incrementalDrag", &data->enableIncrementalDrag);
+			ImGui::SameLine(0);
+			ImGui::InputFloat("dragTolerance", &data->dragTolerance);
+			ImGui::Checkbox("arcLengthSampling", &data->arcLengthSampling);
+			ImGui::SameLine(0);
+			ImGui::InputFloat("arcSpacing", &data->arcSpacing);
+			ImGui::Checkbox("smoothing", &data->enableSmoothing);
+			ImGui::SameLine(0);
+			ImGui::InputFloat("smoothLambda", &data->smoothLambda);
 
 			ShowDebugInfo(data);
 			//AddDebugSwitch(data);
@@ -421,6 +526,7 @@ void CubicSpline::OnUpdate(UECS::Schedule& schedule)
 				float yPos = canvasDiagonal.y - io.MousePos.y;
 				data->xs.back() = xPos;
 				data->ys.back() = yPos;
+				knotGrid.Set(data->xs.size() - 1, xPos, yPos);
 			}
 			// move derivative point
 			if (data->moveDerivative != -1) {
@@ -498,6 +604,7 @@ void CubicSpline::OnUpdate(UECS::Schedule& schedule)
 					}
 					break;
 					}
+					UpdateHandles(ix, control);
 				}
 			}
 			// move exist point
@@ -509,6 +616,7 @@ void CubicSpline::OnUpdate(UECS::Schedule& schedule)
 				}
 				data->xs[data->movePoint] += xDelta;
 				data->ys[data->movePoint] -= yDelta;
+				knotGrid.Set(data->movePoint, data->xs[data->movePoint], data->ys[data->movePoint]);
 			}
 
 			if (isHover && ImGui::IsMouseDown(ImGuiMouseButton_Left) 
@@ -519,13 +627,15 @@ void CubicSpline::OnUpdate(UECS::Schedule& schedule)
 				float xPos = io.MousePos.x - canvasOrigin.x;
 				float yPos = canvasDiagonal.y - io.MousePos.y;
 				bool isP1 = false;
-				int ix = SelectPoint(ImVec2(xPos, yPos), CONTROL_POINT_RADIUS, data->xs, data->ys);
-				int ixDPoint = SelectPoint(ImVec2(xPos, yPos), CONTROL_POINT_RADIUS, data->controls, isP1);
+				SyncKnotGrid(data);
+				int ix = SelectPoint(ImVec2(xPos, yPos), CONTROL_POINT_RADIUS, knotGrid);
+				int ixDPoint = SelectPoint(ImVec2(xPos, yPos), CONTROL_POINT_RADIUS, handleGrid, isP1);
 				// add new point
 				if (-1 == ix && -1 == ixDPoint) {
 					data->xs.emplace_back(xPos);
 					data->ys.emplace_back(yPos);
 					data->controls.emplace_back(ControlPoint());
+					knotGrid.Set(data->xs.size() - 1, xPos, yPos);
 					data->addingPoint = true;
 					ClearSelectPoint(data);
 				}
@@ -558,6 +668,7 @@ void CubicSpline::OnUpdate(UECS::Schedule& schedule)
 				if (!control.hasMove) {
 					// if you no move. you select it.
 					control.isSelect = !data->gizmoShowState;
+					UpdateHandles(data->movePoint, control);
 				}
 				control.hasMove = false;
 				data->movePoint = -1;
@@ -586,11 +697,17 @@ void CubicSpline::OnUpdate(UECS::Schedule& schedule)
 					data->xs.clear();
 					data->ys.clear();
 					data->controls.clear();
+					knotGrid.Clear();
+					handleGrid.Clear();
 				}
 				if (ImGui::MenuItem("RemoveOne", NULL, false, data->xs.size() > 0 && data->ys.size() > 0)) {
-					data->xs.resize(data->xs.size() - 1);
-					data->ys.resize(data->ys.size() - 1);
-					data->controls.resize(data->controls.size() - 1);
+					int last = data->xs.size() - 1;
+					data->xs.resize(last);
+					data->ys.resize(last);
+					data->controls.resize(last);
+					knotGrid.Remove(last);
+					handleGrid.Remove(2 * last);
+					handleGrid.Remove(2 * last + 1);
 				}
 				ImGui::EndPopup();
 			}
@@ -598,14 +715,41 @@ void CubicSpline::OnUpdate(UECS::Schedule& schedule)
 			DrawPoint(data, drawList, canvasOrigin, canvasDiagonal);
 
 			drawList->PushClipRect(canvasOrigin, canvasDiagonal, true);
+			bool drawSpline = (data->enableCubicSplineFn && data->xs.size() >= 3)
+				|| (data->enableCurve && data->controls.size() >= 3);
 			if (data->enableCubicSplineFn && data->xs.size() >= 3) {
-				Draw(CubicSplineFn(data->xs, data->ys, data->delta), canvasOrigin, canvasSize, drawList, IM_COL32(255, 0, 0, 255));
+				Draw(CubicSplineFn(data), canvasOrigin, canvasSize, drawList, IM_COL32(255, 0, 0, 255));
+				if (data->enableSmoothing) {
+					const float* columns[] = { data->ys.data() };
+					Draw(SmoothingSplinePoints(data->xs.data(), columns, 1, data->xs.size(), data->smoothLambda, data->delta),
+						canvasOrigin, canvasSize, drawList, IM_COL32(0, 255, 255, 255));
+				}
 			}
 			else if (data->enableCurve && data->controls.size() >= 3) {
-				data->ts = Parameterization2(data->xs, data->ys, (ParamMode)data->paramMode, data->tInterval);
-				CubicSplineCurve(data, drawList, canvasOrigin, canvasSize);
+				// Dragging a point only redoes the parameters from that point on.
+				static ParameterizationCache paramCache;
+				const std::vector<float>* xs;
+				const std::vector<float>* ys;
+				CurveKnots(data, xs, ys);
+				data->ts = paramCache.Sync(*xs, *ys, (ParamMode)data->paramMode, data->tInterval);
+				CubicSplineCurve(data, *xs, *ys, drawList, canvasOrigin, canvasSize);
+				if (data->enableSmoothing) {
+					// Open curve through the knots, the closing knot of a loop is left out.
+					const float* columns[] = { data->xs.data(), data->ys.data() };
+					Draw(SmoothingSplinePoints(data->ts.data(), columns, 2, data->xs.size(), data->smoothLambda, data->tDelta),
+						canvasOrigin, canvasSize, drawList, IM_COL32(0, 255, 255, 255));
+				}
 				DrawSelectGizmo(data, drawList, canvasOrigin, canvasDiagonal);
 			}
+			// Mark where the spline passes closest to an idle mouse.
+			if (drawSpline && isHover && !data->addingPoint && data->movePoint == -1 && data->moveDerivative == -1) {
+				float xPos = io.MousePos.x - canvasOrigin.x;
+				float yPos = canvasDiagonal.y - io.MousePos.y;
+				CurveHit hit = NearestOnSpline(xPos, yPos, 2 * CONTROL_POINT_RADIUS);
+				if (hit.piece != -1) {
+					drawList->AddCircle(ImVec2(canvasOrigin.x + hit.x, canvasDiagonal.y - hit.y), CONTROL_POINT_RADIUS / 2, IM_COL32(255, 255, 255, 255), 0, 2.0f);
+				}
+			}
 			drawList->PopClipRect();
 		}
 		ImGui::End();
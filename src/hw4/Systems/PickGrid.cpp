@@ -0,0 +1,90 @@
+#include "PickGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void PickGrid::Clear() {
+	size = 0;
+	entries.clear();
+	cells.clear();
+}
+
+void PickGrid::Set(int id, float x, float y) {
+	if (id >= static_cast<int>(entries.size())) {
+		entries.resize(id + 1);
+	}
+	Entry& entry = entries[id];
+	CellKey cell = Key(CellCoord(x), CellCoord(y));
+	if (entry.alive && entry.cell != cell) {
+		Unlink(id);
+	}
+	if (!entry.alive || entry.cell != cell) {
+		cells[cell].push_back(id);
+	}
+	if (!entry.alive) {
+		++size;
+	}
+	entry.x = x;
+	entry.y = y;
+	entry.cell = cell;
+	entry.alive = true;
+}
+
+void PickGrid::Remove(int id) {
+	if (!Contains(id)) return;
+	Unlink(id);
+	entries[id].alive = false;
+	--size;
+	// Keep entries dense, ids are usually removed from the back.
+	while (!entries.empty() && !entries.back().alive) {
+		entries.pop_back();
+	}
+}
+
+int PickGrid::Nearest(float x, float y, float radius) const {
+	int best = -1;
+	float bestDistance = std::numeric_limits<float>::max();
+	int cxEnd = CellCoord(x + radius);
+	int cyEnd = CellCoord(y + radius);
+	for (int cx = CellCoord(x - radius); cx <= cxEnd; ++cx) {
+		for (int cy = CellCoord(y - radius); cy <= cyEnd; ++cy) {
+			auto it = cells.find(Key(cx, cy));
+			if (it == cells.end()) continue;
+
+			for (int id : it->second) {
+				const Entry& entry = entries[id];
+				float dx = entry.x - x;
+				float dy = entry.y - y;
+				if (std::abs(dx) >= radius || std::abs(dy) >= radius) continue;
+
+				// Unlike the former linear scan, which took the first point
+				// in index order, the nearest point wins; ties go to the lower id.
+				float distance = dx * dx + dy * dy;
+				if (distance < bestDistance || (distance == bestDistance && id < best)) {
+					bestDistance = distance;
+					best = id;
+				}
+			}
+		}
+	}
+	return best;
+}
+
+int PickGrid::CellCoord(float v) const {
+	return static_cast<int>(std::floor(v / cellSize));
+}
+
+PickGrid::CellKey PickGrid::Key(int cx, int cy) {
+	return (static_cast<CellKey>(cx) << 32) ^ static_cast<unsigned int>(cy);
+}
+
+void PickGrid::Unlink(int id) {
+	auto it = cells.find(entries[id].cell);
+	std::vector<int>& ids = it->second;
+	*std::find(ids.begin(), ids.end(), id) = ids.back();
+	ids.pop_back();
+	if (ids.empty()) {
+		cells.erase(it);
+	}
+}
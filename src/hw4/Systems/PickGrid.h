@@ -0,0 +1,44 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid over canvas points for picking. Points are identified by a
+// dense id (e.g. the knot index), Set() moves a point in O(1) and Nearest()
+// only visits the cells its query box overlaps, O(1) expected when the cell
+// size is about the query radius.
+class PickGrid {
+public:
+	explicit PickGrid(float cellSize) : cellSize(cellSize) {}
+
+	void Clear();
+	// Add point id or move it to (x, y).
+	void Set(int id, float x, float y);
+	void Remove(int id);
+	bool Contains(int id) const { return id < static_cast<int>(entries.size()) && entries[id].alive; }
+	// True if point id is stored at exactly (x, y).
+	bool IsAt(int id, float x, float y) const { return Contains(id) && entries[id].x == x && entries[id].y == y; }
+	int Size() const { return size; }
+
+	// Id of the point closest to (x, y) with |dx| < radius and |dy| < radius, -1 if none.
+	int Nearest(float x, float y, float radius) const;
+
+private:
+	using CellKey = long long;
+
+	struct Entry {
+		float x;
+		float y;
+		CellKey cell;
+		bool alive{ false };
+	};
+
+	int CellCoord(float v) const;
+	static CellKey Key(int cx, int cy);
+	void Unlink(int id);
+
+	float cellSize;
+	int size{ 0 };
+	std::vector<Entry> entries;
+	std::unordered_map<CellKey, std::vector<int>> cells;
+};
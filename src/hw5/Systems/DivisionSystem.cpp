@@ -1,7 +1,11 @@
 #include "DivisionSystem.h"
+#include "../../Common/Tessellate.h"
 
 using namespace Ubpa;
 
+// Chord error of the drawn subdivision curve, in pixels.
+constexpr float CURVE_TOLERANCE = 0.25f;
+
 ImVec2 operator+ (const ImVec2& v1, const ImVec2& v2) {
 	return ImVec2(v1.x + v2.x, v1.y + v2.y);
 }
@@ -127,18 +131,22 @@ std::vector<Ubpa::pointf2> InterpolateFn(const std::vector<Ubpa::pointf2>& verti
 	return v;
 }
 
-void Draw(const std::vector<pointf2>& points, const ImVec2& canvasOrigin, const ImVec2& canvasDiagonal, ImDrawList* drawList, const ImU32& color) {
-	if (points.size() < 1) return;
+// Closed polygon, one polyline.
+void DrawLine(const std::vector<pointf2>& points, const ImVec2& canvasOrigin, const ImVec2& canvasDiagonal, ImDrawList* drawList, const ImU32& color) {
+	if (points.size() < 2) return;
 
-	pointf2 prePoint = pointf2(canvasOrigin.x + points[0][0], canvasDiagonal.y - points[0][1]);
-	for (int i = 1; i < points.size(); ++i) {
-		pointf2 curPoint = pointf2(canvasOrigin.x + points[i][0], canvasDiagonal.y - points[i][1]);
-		drawList->AddLine(prePoint, curPoint, color);
-		prePoint = curPoint;
+	std::vector<ImVec2> screen(points.size());
+	for (int i = 0; i < points.size(); ++i) {
+		screen[i] = ImVec2(canvasOrigin.x + points[i][0], canvasDiagonal.y - points[i][1]);
 	}
+	drawList->AddPolyline(screen.data(), screen.size(), color, true, 1.0f);
+}
 
-	drawList->AddLine(pointf2(canvasOrigin.x + points[0][0], canvasDiagonal.y - points[0][1]),
-		pointf2(canvasOrigin.x + points[points.size() - 1][0], canvasDiagonal.y - points[points.size() - 1][1]), color);
+// Dense subdivision result, vertices within CURVE_TOLERANCE of the rest are dropped.
+void Draw(const std::vector<pointf2>& points, const ImVec2& canvasOrigin, const ImVec2& canvasDiagonal, ImDrawList* drawList, const ImU32& color) {
+	std::vector<pointf2> kept;
+	Simplify(points, CURVE_TOLERANCE, kept);
+	DrawLine(kept, canvasOrigin, canvasDiagonal, drawList, color);
 }
 
 void DrawPoint(const std::vector<pointf2>& points, const ImVec2& canvasOrigin, const ImVec2& canvasDiagonal, ImDrawList* drawList, const ImU32& color) {
@@ -148,19 +156,6 @@ void DrawPoint(const std::vector<pointf2>& points, const ImVec2& canvasOrigin, c
 	}
 }
 
-void DrawLine(const std::vector<pointf2>& points, const ImVec2& canvasOrigin, const ImVec2& canvasDiagonal, ImDrawList* drawList, const ImU32& color) {
-	if (points.size() < 1) return;
-
-	pointf2 prePoint = pointf2(canvasOrigin.x + points[0][0], canvasDiagonal.y - points[0][1]);
-	for (int i = 1; i < points.size(); ++i) {
-		pointf2 curPoint = pointf2(canvasOrigin.x + points[i][0], canvasDiagonal.y - points[i][1]);
-		drawList->AddLine(prePoint, curPoint, color);
-		prePoint = curPoint;
-	}
-	drawList->AddLine(pointf2(canvasOrigin.x + points[0][0], canvasDiagonal.y - points[0][1]),
-		pointf2(canvasOrigin.x + points[points.size() - 1][0], canvasDiagonal.y - points[points.size() - 1][1]), color);
-}
-
 void DivisionSystem::OnUpdate(Ubpa::UECS::Schedule& schedule)
 {
 	schedule.RegisterCommand([](Ubpa::UECS::World* w){